@@ -17,6 +17,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Point.h"
 #include "Random.h"
 #include "Sound.h"
+#include "Timeline.h"
 
 #ifndef __APPLE__
 #include <AL/al.h>
@@ -27,7 +28,9 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstddef>
 #include <map>
 #include <mutex>
 #include <set>
@@ -44,7 +47,6 @@ namespace {
 	class QueueEntry {
 	public:
 		void Add(Point position);
-		void Add(const QueueEntry &other);
 		
 		Point sum;
 		double weight = 0.;
@@ -58,13 +60,42 @@ namespace {
 	public:
 		Source(const Sound *sound, unsigned source);
 		
-		void Move(const QueueEntry &entry) const;
+		void Move(const QueueEntry &entry);
 		unsigned ID() const;
 		const Sound *GetSound() const;
+		// Get how loud this source was the last time it was moved.
+		double Loudness() const;
 		
 	private:
 		const Sound *sound = nullptr;
 		unsigned source = 0;
+		double loudness = 0.;
+	};
+	
+	// Requests to play a sound that were made from threads other than the main
+	// one are placed in this fixed-size ring buffer. Any number of threads can
+	// add requests without waiting on a lock, and only the main thread removes
+	// them. Each slot's sequence number says whether it is ready to be written
+	// or to be read. If the buffer is full, new requests are dropped.
+	class RequestQueue {
+	public:
+		RequestQueue();
+		
+		bool Push(const Sound *sound, const Point &position);
+		bool Pop(const Sound *&sound, Point &position);
+		
+	private:
+		static const size_t SIZE = 4096;
+		
+		struct Slot {
+			atomic<size_t> sequence;
+			const Sound *sound;
+			Point position;
+		};
+		
+		Slot slots[SIZE];
+		atomic<size_t> pushed;
+		size_t popped = 0;
 	};
 	
 	// Thread entry point for loading the sound files.
@@ -81,10 +112,11 @@ namespace {
 	double volume = .125;
 	
 	// This queue keeps track of sounds that have been requested to play. Each
-	// added sound is "deferred" until the next audio position update to make
-	// sure that all sounds from a given frame start at the same time.
+	// sound added from another thread is "deferred" until the next audio
+	// position update to make sure that all sounds from a given frame start at
+	// the same time.
 	map<const Sound *, QueueEntry> queue;
-	map<const Sound *, QueueEntry> deferred;
+	RequestQueue deferred;
 	thread::id mainThreadID;
 	
 	// Sound resources that have been loaded from files.
@@ -95,10 +127,19 @@ namespace {
 	vector<unsigned> recycledSources;
 	vector<unsigned> endingSources;
 	unsigned maxSources = 255;
-	
-	// Queue and thread for loading sound files in the background.
+	// Only this many sounds play at once. If more than that are requested, the
+	// loudest ones are played. Many instances of the same sound are already
+	// combined into a single source, so this is rarely reached except in very
+	// large battles with many different weapons.
+	const size_t MAX_VOICES = 64;
+	int droppedVoices = 0;
+	
+	// Queue and threads for loading sound files in the background. Each
+	// thread takes the next file from the queue until none are left.
 	map<string, string> loadQueue;
-	thread loadThread;
+	vector<thread> loadThreads;
+	size_t soundsToLoad = 0;
+	size_t soundsLoaded = 0;
 	
 	// The current position of the "listener," i.e. the center of the screen.
 	Point listener;
@@ -160,9 +201,13 @@ void Audio::Init(const vector<string> &sources)
 			}
 		}
 	}
-	// Begin loading the files.
-	if(!loadQueue.empty())
-		loadThread = thread(&Load);
+	// Begin loading the files. Reading the files is quick, so most of the
+	// time is spent converting and copying the data into OpenAL's buffers,
+	// which can be done for several sounds at once.
+	soundsToLoad = loadQueue.size();
+	unsigned threadCount = min(4u, max(1u, thread::hardware_concurrency()));
+	for(unsigned i = 0; i < threadCount && i < soundsToLoad; ++i)
+		loadThreads.emplace_back(&Load);
 	
 	// Create the music-streaming threads.
 	currentTrack.reset(new Music());
@@ -186,12 +231,10 @@ double Audio::GetProgress()
 {
 	unique_lock<mutex> lock(audioMutex);
 	
-	if(loadQueue.empty())
+	if(soundsLoaded == soundsToLoad)
 		return 1.;
 	
-	double done = sounds.size();
-	double total = done + loadQueue.size();
-	return done / total;
+	return static_cast<double>(soundsLoaded) / static_cast<double>(soundsToLoad);
 }
 
 
@@ -234,9 +277,10 @@ void Audio::Update(const Point &listenerPosition)
 	
 	listener = listenerPosition;
 	
-	for(const auto &it : deferred)
-		queue[it.first].Add(it.second);
-	deferred.clear();
+	const Sound *sound = nullptr;
+	Point position;
+	while(deferred.Pop(sound, position))
+		queue[sound].Add(position);
 }
 
 
@@ -261,10 +305,7 @@ void Audio::Play(const Sound *sound, const Point &position)
 	if(this_thread::get_id() == mainThreadID)
 		queue[sound].Add(position - listener);
 	else
-	{
-		unique_lock<mutex> lock(audioMutex);
-		deferred[sound].Add(position - listener);
-	}
+		deferred.Push(sound, position - listener);
 }
 
 
@@ -295,7 +336,7 @@ void Audio::Step()
 	vector<Source> newSources;
 	// For each sound that is looping, see if it is going to continue. For other
 	// sounds, check if they are done playing.
-	for(const Source &source : sources)
+	for(Source &source : sources)
 	{
 		if(source.GetSound()->IsLooping())
 		{
@@ -348,9 +389,38 @@ void Audio::Step()
 	newSources.swap(sources);
 	
 	// Now, what is left in the queue is sounds that want to play, and that do
-	// not correspond to an existing source.
+	// not correspond to an existing source. Start the loudest ones first.
+	vector<pair<double, const Sound *>> requests;
 	for(const auto &it : queue)
+		requests.emplace_back(it.second.weight, it.first);
+	sort(requests.begin(), requests.end(),
+		[](const pair<double, const Sound *> &a, const pair<double, const Sound *> &b) { return a.first > b.first; });
+	
+	droppedVoices = 0;
+	for(const auto &request : requests)
 	{
+		const QueueEntry &entry = queue[request.second];
+		if(sources.size() >= MAX_VOICES)
+		{
+			// All the voices are in use. If any looping sound is quieter than
+			// this one, fade it out to make room. It will start again once
+			// there is a free voice if its source is still playing it.
+			auto quietest = sources.end();
+			for(auto it = sources.begin(); it != sources.end(); ++it)
+				if(it->GetSound()->IsLooping() && it->Loudness() < request.first
+						&& (quietest == sources.end() || it->Loudness() < quietest->Loudness()))
+					quietest = it;
+			if(quietest == sources.end())
+			{
+				++droppedVoices;
+				continue;
+			}
+			alSourcei(quietest->ID(), AL_LOOPING, false);
+			endingSources.push_back(quietest->ID());
+			sources.erase(quietest);
+			++droppedVoices;
+		}
+		
 		// Use a recycled source if possible. Otherwise, create a new one.
 		unsigned source = 0;
 		if(recycledSources.empty())
@@ -374,8 +444,8 @@ void Audio::Step()
 			recycledSources.pop_back();
 		}
 		// Begin playing this sound.
-		sources.emplace_back(it.first, source);
-		sources.back().Move(it.second);
+		sources.emplace_back(request.second, source);
+		sources.back().Move(entry);
 		alSourcePlay(source);
 	}
 	queue.clear();
@@ -420,20 +490,35 @@ void Audio::Step()
 
 
 
+// Get the number of sounds that were playing after the last Step().
+int Audio::ActiveVoices()
+{
+	return sources.size() + endingSources.size();
+}
+
+
+
+// Get the number of requested sounds that were not played in the last Step()
+// because of the limit on how many sounds can play at once.
+int Audio::DroppedVoices()
+{
+	return droppedVoices;
+}
+
+
+
 // Shut down the audio system (because we're about to quit).
 void Audio::Quit()
 {
 	// First, check if sounds are still being loaded in a separate thread, and
 	// if so interrupt that thread and wait for it to quit.
 	unique_lock<mutex> lock(audioMutex);
-	if(!loadQueue.empty())
-		loadQueue.clear();
-	if(loadThread.joinable())
-	{
-		lock.unlock();
+	loadQueue.clear();
+	lock.unlock();
+	for(thread &loadThread : loadThreads)
 		loadThread.join();
-		lock.lock();
-	}
+	loadThreads.clear();
+	lock.lock();
 	
 	// Now, stop and delete any OpenAL sources that are playing.
 	for(const Source &source : sources)
@@ -488,6 +573,67 @@ void Audio::Quit()
 
 
 namespace {
+	RequestQueue::RequestQueue()
+		: pushed(0)
+	{
+		for(size_t i = 0; i < SIZE; ++i)
+			slots[i].sequence.store(i, memory_order_relaxed);
+	}
+	
+	
+	
+	// Add a request to play a sound. This may be called from any thread.
+	// Return false if the queue is full.
+	bool RequestQueue::Push(const Sound *sound, const Point &position)
+	{
+		size_t index = pushed.load(memory_order_relaxed);
+		Slot *slot = nullptr;
+		while(true)
+		{
+			slot = &slots[index % SIZE];
+			size_t sequence = slot->sequence.load(memory_order_acquire);
+			// If the slot's sequence number equals the index, the slot is free
+			// and this thread can try to claim it. If it is lower, the reader
+			// has not caught up yet and the queue is full. Otherwise, another
+			// thread claimed this index first, so try again with the new one.
+			if(sequence == index)
+			{
+				if(pushed.compare_exchange_weak(index, index + 1, memory_order_relaxed))
+					break;
+			}
+			else if(static_cast<ptrdiff_t>(sequence - index) < 0)
+				return false;
+			else
+				index = pushed.load(memory_order_relaxed);
+		}
+		slot->sound = sound;
+		slot->position = position;
+		// Signal to the reader that this slot now holds a request.
+		slot->sequence.store(index + 1, memory_order_release);
+		return true;
+	}
+	
+	
+	
+	// Remove the oldest request. This must only be called from one thread.
+	// Return false if there are no requests that are ready to be removed.
+	bool RequestQueue::Pop(const Sound *&sound, Point &position)
+	{
+		Slot &slot = slots[popped % SIZE];
+		if(slot.sequence.load(memory_order_acquire) != popped + 1)
+			return false;
+		
+		sound = slot.sound;
+		position = slot.position;
+		// Signal to the writers that this slot is free for the next time the
+		// ring buffer wraps around to it.
+		slot.sequence.store(popped + SIZE, memory_order_release);
+		++popped;
+		return true;
+	}
+	
+	
+	
 	// Add a new source to this queue entry. Sources are weighted based on their
 	// position, and multiple sources can be added together in the same entry.
 	void QueueEntry::Add(Point position)
@@ -503,15 +649,6 @@ namespace {
 	
 	
 	
-	// Combine two queue entries.
-	void QueueEntry::Add(const QueueEntry &other)
-	{
-		sum += other.sum;
-		weight += other.weight;
-	}
-	
-	
-	
 	// This is a wrapper for an OpenAL audio source.
 	Source::Source(const Sound *sound, unsigned source)
 		: sound(sound), source(source)
@@ -531,8 +668,9 @@ namespace {
 	
 	
 	// Reposition this source based on the given entry in a sound queue.
-	void Source::Move(const QueueEntry &entry) const
+	void Source::Move(const QueueEntry &entry)
 	{
+		loudness = entry.weight;
 		Point angle = entry.sum / entry.weight;
 		// The source should be along the vector (angle.X(), angle.Y(), 1).
 		// The length of the vector should be sqrt(1 / weight).
@@ -558,34 +696,47 @@ namespace {
 	
 	
 	
+	// Get how loud this source was the last time it was moved. This is the sum
+	// of the loudness of all the instances of its sound, based on how far
+	// each is from the listener.
+	double Source::Loudness() const
+	{
+		return loudness;
+	}
+	
+	
+	
 	// Thread entry point for loading sounds.
 	void Load()
 	{
-		string name;
-		string path;
-		Sound *sound;
+		Timeline::NameThread("sound loader");
 		while(true)
 		{
+			string name;
+			string path;
+			Sound *sound;
 			{
 				unique_lock<mutex> lock(audioMutex);
-				// If this is not the first time through, remove the previous item
-				// in the queue. This is a signal that it has been loaded, so we
-				// must not remove it until after loading the file.
-				if(!path.empty() && !loadQueue.empty())
-					loadQueue.erase(loadQueue.begin());
 				if(loadQueue.empty())
 					return;
 				name = loadQueue.begin()->first;
 				path = loadQueue.begin()->second;
-
-				// Since we need to unlock the mutex below, create the map entry to
-				// avoid a race condition when accessing sounds' size.
+				loadQueue.erase(loadQueue.begin());
+				
+				// Since we need to unlock the mutex below, create the map entry
+				// while the mutex is locked.
 				sound = &sounds[name];
 			}
 			
 			// Unlock the mutex for the time-intensive part of the loop.
-			if(!sound->Load(path, name))
-				Files::LogError("Unable to load sound \"" + name + "\" from path: " + path);
+			{
+				Timeline::Scope scope("Load sound", name);
+				if(!sound->Load(path, name))
+					Files::LogError("Unable to load sound \"" + name + "\" from path: " + path);
+			}
+			
+			unique_lock<mutex> lock(audioMutex);
+			++soundsLoaded;
 		}
 	}
 }
@@ -64,6 +64,12 @@ public:
 	// this function was called.
 	static void Step();
 	
+	// Get the number of sounds that were playing after the last Step(), and
+	// the number of requested sounds that were not played because too many
+	// louder sounds were already playing.
+	static int ActiveVoices();
+	static int DroppedVoices();
+	
 	// Shut down the audio system (because we're about to quit).
 	static void Quit();
 };
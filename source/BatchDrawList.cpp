@@ -17,11 +17,18 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Screen.h"
 #include "Sprite.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
 
 namespace {
+	// Each vertex that is added to the list holds its (x, y) position, its
+	// (s, t) texture coordinates within the sprite, and the sprite frame.
+	const size_t VERTEX_SIZE = 5;
+	// Each sprite is drawn as six vertices.
+	const size_t SPRITE_SIZE = 6 * VERTEX_SIZE;
+	
 	void Push(vector<float> &v, const Point &pos, float s, float t, float frame)
 	{
 		v.push_back(pos.X());
@@ -30,6 +37,24 @@ namespace {
 		v.push_back(t);
 		v.push_back(frame);
 	}
+	
+	// Convert a vertex to the form the shader uses, given where in the texture
+	// its frame and the one after it are.
+	void Push(vector<float> &v, const float *vertex,
+		const TextureAtlas::Region &first, const TextureAtlas::Region &second, float blend)
+	{
+		float s = vertex[2];
+		float t = vertex[3];
+		v.push_back(vertex[0]);
+		v.push_back(vertex[1]);
+		v.push_back(first.left + s * (first.right - first.left));
+		v.push_back(first.top + t * (first.bottom - first.top));
+		v.push_back(first.layer);
+		v.push_back(second.left + s * (second.right - second.left));
+		v.push_back(second.top + t * (second.bottom - second.top));
+		v.push_back(second.layer);
+		v.push_back(blend);
+	}
 }
 
 
@@ -81,10 +106,39 @@ bool BatchDrawList::AddVisual(const Body &visual)
 // Draw all the items in this list.
 void BatchDrawList::Draw() const
 {
+	// Each sprite's texture, and where its frames are in that texture, can
+	// change when the sprite is uploaded or evicted, which only happens in this
+	// thread. So they are looked up here rather than when the sprites are added.
+	// Sprites that share a texture atlas are then drawn with a single command.
+	map<uint32_t, vector<float>> batches;
+	for(const pair<const Sprite * const, vector<float>> &it : data)
+	{
+		const Sprite *sprite = it.first;
+		const vector<float> &vertices = it.second;
+		vector<float> &v = batches[sprite->BatchTexture(isHighDPI)];
+		// The shader takes nine attributes for each vertex.
+		v.reserve(v.size() + vertices.size() / VERTEX_SIZE * 9);
+		
+		int frames = max(1, sprite->Frames());
+		for(size_t i = 0; i + SPRITE_SIZE <= vertices.size(); i += SPRITE_SIZE)
+		{
+			// The sprite frame is the same for every vertex. Find where that
+			// frame and the one after it, which it is blended with, are.
+			float frame = vertices[i + 4];
+			float firstFrame = floor(frame);
+			float blend = frame - firstFrame;
+			TextureAtlas::Region first = sprite->BatchRegion(static_cast<int>(firstFrame) % frames, isHighDPI);
+			TextureAtlas::Region second = sprite->BatchRegion(static_cast<int>(ceil(frame)) % frames, isHighDPI);
+			
+			for(size_t j = i; j < i + SPRITE_SIZE; j += VERTEX_SIZE)
+				Push(v, &vertices[j], first, second, blend);
+		}
+	}
+	
 	BatchShader::Bind();
 	
-	for(const pair<const Sprite * const, vector<float>> &it : data)
-		BatchShader::Add(it.first, isHighDPI, it.second);
+	for(const pair<const uint32_t, vector<float>> &it : batches)
+		BatchShader::Add(it.first, it.second);
 	
 	BatchShader::Unbind();
 }
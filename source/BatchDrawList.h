@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Point.h"
 
+#include <cstdint>
 #include <map>
 #include <vector>
 
@@ -24,7 +25,8 @@ class Sprite;
 
 
 // This class collects a set of OpenGL draw commands to issue and groups them by
-// sprite, so all instances of each sprite can be drawn with a single command.
+// texture, so all instances of each sprite can be drawn with a single command.
+// Small sprites that share a texture atlas are also drawn together.
 class BatchDrawList {
 public:
 	// Clear the list, also setting the global time step for animation.
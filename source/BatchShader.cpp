@@ -14,7 +14,6 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Screen.h"
 #include "Shader.h"
-#include "Sprite.h"
 
 using namespace std;
 
@@ -22,13 +21,17 @@ namespace {
 	Shader shader;
 	// Uniforms:
 	GLint scaleI;
-	GLint frameCountI;
 	// Vertex data:
 	GLint vertI;
 	GLint texCoordI;
+	GLint blendTexCoordI;
+	GLint blendI;
 	
 	GLuint vao;
 	GLuint vbo;
+	
+	int binds = 0;
+	int drawCalls = 0;
 }
 
 
@@ -41,12 +44,18 @@ void BatchShader::Init()
 		"uniform vec2 scale;\n"
 		"in vec2 vert;\n"
 		"in vec3 texCoord;\n"
+		"in vec3 blendTexCoord;\n"
+		"in float blend;\n"
 		
 		"out vec3 fragTexCoord;\n"
+		"out vec3 fragBlendTexCoord;\n"
+		"out float fragBlend;\n"
 		
 		"void main() {\n"
 		"  gl_Position = vec4(vert * scale, 0, 1);\n"
 		"  fragTexCoord = texCoord;\n"
+		"  fragBlendTexCoord = blendTexCoord;\n"
+		"  fragBlend = blend;\n"
 		"}\n";
 	
 	static const char *fragmentCode =
@@ -54,28 +63,27 @@ void BatchShader::Init()
 		"precision mediump float;\n"
 		"precision mediump sampler2DArray;\n"
 		"uniform sampler2DArray tex;\n"
-		"uniform float frameCount;\n"
 		
 		"in vec3 fragTexCoord;\n"
+		"in vec3 fragBlendTexCoord;\n"
+		"in float fragBlend;\n"
 		
 		"out vec4 finalColor;\n"
 		
 		"void main() {\n"
-		"  float first = floor(fragTexCoord.z);\n"
-		"  float second = mod(ceil(fragTexCoord.z), frameCount);\n"
-		"  float fade = fragTexCoord.z - first;\n"
 		"  finalColor = mix(\n"
-		"    texture(tex, vec3(fragTexCoord.xy, first)),\n"
-		"    texture(tex, vec3(fragTexCoord.xy, second)), fade);\n"
+		"    texture(tex, fragTexCoord),\n"
+		"    texture(tex, fragBlendTexCoord), fragBlend);\n"
 		"}\n";
 	
 	// Compile the shaders.
 	shader = Shader(vertexCode, fragmentCode);
 	// Get the indices of the uniforms and attributes.
 	scaleI = shader.Uniform("scale");
-	frameCountI = shader.Uniform("frameCount");
 	vertI = shader.Attrib("vert");
 	texCoordI = shader.Attrib("texCoord");
+	blendTexCoordI = shader.Attrib("blendTexCoord");
+	blendI = shader.Attrib("blend");
 	
 	// Make sure we're using texture 0.
 	glUseProgram(shader.Object());
@@ -89,14 +97,22 @@ void BatchShader::Init()
 	glGenBuffers(1, &vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 	
-	// In this VAO, enable the two vertex arrays and specify their byte offsets.
-	constexpr auto stride = 5 * sizeof(float);
+	// In this VAO, enable the four vertex arrays and specify their byte offsets.
+	constexpr auto stride = 9 * sizeof(float);
 	glEnableVertexAttribArray(vertI);
 	glVertexAttribPointer(vertI, 2, GL_FLOAT, GL_FALSE, stride, nullptr);
-	// The 3 texture fields (s, t, frame) come after the x,y pixel fields.
+	// The 3 texture fields (s, t, layer) of the current frame come after the
+	// x,y pixel fields, followed by those of the frame to blend it with and the
+	// amount to blend them.
 	auto textureOffset = reinterpret_cast<const GLvoid *>(2 * sizeof(float));
 	glEnableVertexAttribArray(texCoordI);
 	glVertexAttribPointer(texCoordI, 3, GL_FLOAT, GL_FALSE, stride, textureOffset);
+	auto blendTextureOffset = reinterpret_cast<const GLvoid *>(5 * sizeof(float));
+	glEnableVertexAttribArray(blendTexCoordI);
+	glVertexAttribPointer(blendTexCoordI, 3, GL_FLOAT, GL_FALSE, stride, blendTextureOffset);
+	auto blendOffset = reinterpret_cast<const GLvoid *>(8 * sizeof(float));
+	glEnableVertexAttribArray(blendI);
+	glVertexAttribPointer(blendI, 1, GL_FLOAT, GL_FALSE, stride, blendOffset);
 	
 	// Unbind the buffer and the VAO, but leave the vertex attrib arrays enabled
 	// in the VAO so they will be used when it is bound.
@@ -120,22 +136,22 @@ void BatchShader::Bind()
 
 
 
-void BatchShader::Add(const Sprite *sprite, bool isHighDPI, const vector<float> &data)
+void BatchShader::Add(uint32_t texture, const vector<float> &data)
 {
 	// Do nothing if there are no sprites to draw.
 	if(data.empty())
 		return;
 	
 	// First, bind the proper texture.
-	glBindTexture(GL_TEXTURE_2D_ARRAY, sprite->Texture(isHighDPI));
-	// The shader also needs to know how many frames the texture has.
-	glUniform1f(frameCountI, sprite->Frames());
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	++binds;
 	
 	// Upload the vertex data.
 	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * data.size(), data.data(), GL_STREAM_DRAW);
 	
 	// Draw all the vertices.
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, data.size() / 5);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, data.size() / 9);
+	++drawCalls;
 }
 
 
@@ -147,3 +163,25 @@ void BatchShader::Unbind()
 	glBindVertexArray(0);
 	glUseProgram(0);
 }
+
+
+
+int BatchShader::Binds()
+{
+	return binds;
+}
+
+
+
+int BatchShader::DrawCalls()
+{
+	return drawCalls;
+}
+
+
+
+void BatchShader::ResetCounts()
+{
+	binds = 0;
+	drawCalls = 0;
+}
@@ -13,22 +13,28 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef BATCH_SHADER_H_
 #define BATCH_SHADER_H_
 
-class Sprite;
-
+#include <cstdint>
 #include <vector>
 
 
 
 // Class for drawing sprites in a batch. The input to each draw command is a
-// sprite, whether it should be drawn high DPI, and the vertex data.
+// texture and the vertex data for every sprite that uses that texture. Several
+// different sprites may share one texture if they are in a texture atlas.
 class BatchShader {
 public:
 	// Initialize the shaders.
 	static void Init();
 	
 	static void Bind();
-	static void Add(const Sprite *sprite, bool isHighDPI, const std::vector<float> &data);
+	static void Add(uint32_t texture, const std::vector<float> &data);
 	static void Unbind();
+	
+	// Get the number of texture binds and draw calls since the counts were
+	// last reset, to show how well the sprites are being batched.
+	static int Binds();
+	static int DrawCalls();
+	static void ResetCounts();
 };
 
 
@@ -0,0 +1,346 @@
+/* BinaryData.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "BinaryData.h"
+
+#include "DataNode.h"
+
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+	// Binary files begin with a null character, which text files never do,
+	// followed by a version number.
+	const string MAGIC("\0ESB\1", 5);
+	
+	// Integers with more digits than this are stored as strings, so that
+	// they always fit in a 64-bit number once they are encoded.
+	const size_t MAX_DIGITS = 18;
+	
+	// Numbers are stored seven bits at a time, with the high bit of each byte
+	// marking that more bytes follow.
+	void AppendNumber(string &out, uint64_t value)
+	{
+		while(value >= 0x80)
+		{
+			out += static_cast<char>((value & 0x7F) | 0x80);
+			value >>= 7;
+		}
+		out += static_cast<char>(value);
+	}
+	
+	bool ReadNumber(const string &data, size_t &pos, size_t end, uint64_t &value)
+	{
+		value = 0;
+		for(int shift = 0; pos < end && shift < 64; shift += 7)
+		{
+			uint64_t byte = static_cast<unsigned char>(data[pos++]);
+			value |= (byte & 0x7F) << shift;
+			if(!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+	
+	// Check if a token is an integer that converts back to exactly the same
+	// text, i.e. with no leading zeros, plus sign, or negative zero.
+	bool IsInteger(const string &token, int64_t &value)
+	{
+		size_t start = (!token.empty() && token[0] == '-');
+		size_t digits = token.length() - start;
+		if(!digits || digits > MAX_DIGITS || (token[start] == '0' && (digits > 1 || start)))
+			return false;
+		
+		value = 0;
+		for(size_t i = start; i < token.length(); ++i)
+		{
+			if(token[i] < '0' || token[i] > '9')
+				return false;
+			value = value * 10 + (token[i] - '0');
+		}
+		if(start)
+			value = -value;
+		return true;
+	}
+	
+	// Each token is stored as one number. Zero marks the end of a node's tokens,
+	// odd numbers are integers, and other even numbers are string indices.
+	// Negative numbers are stored as the odd magnitudes, -1 as 1, -2 as 3 and
+	// so on, so that small numbers of either sign fit in a single byte.
+	uint64_t EncodeInteger(int64_t value)
+	{
+		uint64_t zigzag = (value < 0 ? (static_cast<uint64_t>(-value) << 1) - 1 : static_cast<uint64_t>(value) << 1);
+		return (zigzag << 1) | 1;
+	}
+	
+	int64_t DecodeInteger(uint64_t code)
+	{
+		uint64_t zigzag = code >> 1;
+		return (zigzag & 1) ? -static_cast<int64_t>((zigzag + 1) >> 1) : static_cast<int64_t>(zigzag >> 1);
+	}
+}
+
+
+
+// Check if the given file contents are in the binary encoding.
+bool BinaryData::IsBinary(const string &data)
+{
+	return !data.compare(0, MAGIC.length(), MAGIC);
+}
+
+
+
+// Get the length of the start of the given file contents that holds its first
+// section, which can be decoded without reading the rest of the file.
+size_t BinaryData::FirstSectionLength(const string &data)
+{
+	if(!IsBinary(data))
+		return 0;
+	
+	size_t pos = MAGIC.length();
+	uint64_t length = 0;
+	if(!ReadNumber(data, pos, data.length(), length))
+		return 0;
+	return pos + length;
+}
+
+
+
+// Decode the given file contents into children of the given node.
+bool BinaryData::Decode(const string &data, DataNode &root)
+{
+	if(!IsBinary(data))
+		return false;
+	
+	size_t lineNumber = 0;
+	size_t pos = MAGIC.length();
+	size_t end = data.length();
+	
+	// Each section is stored along with its length. If the data ends after any
+	// section, the nodes that were decoded so far are still valid.
+	while(pos < end)
+	{
+		uint64_t length = 0;
+		if(!ReadNumber(data, pos, end, length) || length > end - pos)
+			return false;
+		if(!DecodeSection(data, pos, pos + length, root, lineNumber))
+			return false;
+		pos += length;
+	}
+	return true;
+}
+
+
+
+// Decode a section's string table and then its nodes.
+bool BinaryData::DecodeSection(const string &data, size_t pos, size_t end, DataNode &root, size_t &lineNumber)
+{
+	uint64_t count = 0;
+	if(!ReadNumber(data, pos, end, count) || count > end - pos)
+		return false;
+	
+	vector<string> strings;
+	strings.reserve(count);
+	for(uint64_t i = 0; i < count; ++i)
+	{
+		uint64_t length = 0;
+		if(!ReadNumber(data, pos, end, length) || length > end - pos)
+			return false;
+		strings.emplace_back(data, pos, length);
+		pos += length;
+	}
+	
+	return DecodeBlock(data, pos, end, strings, root, lineNumber);
+}
+
+
+
+// Decode a block of nodes, adding them as children of the given node.
+bool BinaryData::DecodeBlock(const string &data, size_t pos, size_t end, const vector<string> &strings,
+	DataNode &parent, size_t &lineNumber)
+{
+	while(pos < end)
+	{
+		parent.children.emplace_back(&parent);
+		DataNode &node = parent.children.back();
+		node.lineNumber = ++lineNumber;
+		
+		uint64_t code = 0;
+		while(true)
+		{
+			if(!ReadNumber(data, pos, end, code))
+				return false;
+			if(!code)
+				break;
+			if(code & 1)
+				node.tokens.push_back(to_string(static_cast<long long>(DecodeInteger(code))));
+			else if((code >> 1) <= strings.size())
+				node.tokens.push_back(strings[(code >> 1) - 1]);
+			else
+				return false;
+		}
+		if(node.tokens.empty())
+			return false;
+		
+		uint64_t length = 0;
+		if(!ReadNumber(data, pos, end, length) || length > end - pos)
+			return false;
+		if(length && !DecodeBlock(data, pos, pos + length, strings, node, lineNumber))
+			return false;
+		pos += length;
+	}
+	return true;
+}
+
+
+
+BinaryData::BinaryData()
+	: blocks(1), waiting(1, false)
+{
+}
+
+
+
+// Add a token to the node that is being written.
+void BinaryData::AddToken(const string &token)
+{
+	// If the previous node had no children, mark that its block of children
+	// is empty before beginning this one.
+	if(!hasTokens && waiting.back())
+	{
+		blocks.back() += '\0';
+		waiting.back() = false;
+	}
+	hasTokens = true;
+	
+	int64_t value = 0;
+	if(IsInteger(token, value))
+	{
+		AppendNumber(blocks.back(), EncodeInteger(value));
+		return;
+	}
+	
+	auto it = index.find(token);
+	if(it == index.end())
+	{
+		it = index.emplace(token, strings.size()).first;
+		strings.push_back(&it->first);
+	}
+	AppendNumber(blocks.back(), (it->second + 1) << 1);
+}
+
+
+
+// Finish the node that is being written. Empty nodes are not stored, just as
+// blank lines are skipped in a text file.
+void BinaryData::EndNode()
+{
+	if(!hasTokens)
+		return;
+	
+	blocks.back() += '\0';
+	waiting.back() = true;
+	hasTokens = false;
+}
+
+
+
+// Begin writing the children of the most recently finished node.
+void BinaryData::BeginChild()
+{
+	EndNode();
+	blocks.emplace_back();
+	waiting.push_back(false);
+}
+
+
+
+// Finish writing a block of child nodes, and store it along with its length
+// as part of the node that it belongs to.
+void BinaryData::EndChild()
+{
+	EndNode();
+	if(blocks.size() < 2)
+		return;
+	
+	string block;
+	block.swap(blocks.back());
+	if(waiting.back())
+		block += '\0';
+	blocks.pop_back();
+	waiting.pop_back();
+	
+	// Children can only be stored if there is a node for them to belong to.
+	if(!waiting.back())
+		return;
+	AppendNumber(blocks.back(), block.length());
+	blocks.back() += block;
+	waiting.back() = false;
+}
+
+
+
+// Begin a new section. Nodes written after this do not share the string table
+// of the nodes before it, so those can be read without reading the rest.
+void BinaryData::EndSection()
+{
+	EndNode();
+	// Sections can only be split between top-level nodes.
+	if(blocks.size() > 1)
+		return;
+	
+	string section = Section();
+	AppendNumber(sections, section.length());
+	sections += section;
+	
+	strings.clear();
+	index.clear();
+	blocks.front().clear();
+	waiting.front() = false;
+}
+
+
+
+// Get the complete encoded file: each section, along with its length.
+string BinaryData::Contents() const
+{
+	string result = MAGIC + sections;
+	// The section that is being written is left out if it is empty, unless the
+	// file would then have no sections at all.
+	if(sections.empty() || !strings.empty() || !blocks.front().empty())
+	{
+		string section = Section();
+		AppendNumber(result, section.length());
+		result += section;
+	}
+	return result;
+}
+
+
+
+// Get the section that is being written: the string table followed by all
+// the nodes.
+string BinaryData::Section() const
+{
+	string result;
+	AppendNumber(result, strings.size());
+	for(const string *str : strings)
+	{
+		AppendNumber(result, str->length());
+		result += *str;
+	}
+	result += blocks.front();
+	if(waiting.front())
+		result += '\0';
+	return result;
+}
@@ -0,0 +1,92 @@
+/* BinaryData.h
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef BINARY_DATA_H_
+#define BINARY_DATA_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class DataNode;
+
+
+
+// A compact binary encoding of the same tree of nodes and tokens that a text
+// data file holds, used for saved games if the player prefers. The file is made
+// of one or more sections, each stored with its length. A section begins with
+// a table of every distinct string token in it, followed by the nodes, so that
+// the first section can be read without reading the rest of the file. Each node
+// is a list of tokens, each of which is either an index into the string table or
+// an integer stored as a variable-length number, followed by the length of the
+// node's block of children so that a reader can skip over them. Converting a
+// file between the two encodings does not change its contents, except that any
+// comments are not kept in the binary encoding.
+class BinaryData {
+public:
+	// Check if the given file contents are in the binary encoding.
+	static bool IsBinary(const std::string &data);
+	// Get how many bytes at the start of the given file contents hold its first
+	// section, which can be decoded on its own. This only needs the first few
+	// bytes of the file. Returns 0 if the data is not valid.
+	static size_t FirstSectionLength(const std::string &data);
+	// Decode the given file contents, adding each node as a child of the given
+	// root node. Returns false if the data is not valid.
+	static bool Decode(const std::string &data, DataNode &root);
+	
+	BinaryData();
+	
+	// Add a token to the node that is being written.
+	void AddToken(const std::string &token);
+	// Finish the node that is being written. Any node written after this one
+	// will be its sibling unless BeginChild() is called first.
+	void EndNode();
+	// Begin writing the children of the most recently finished node.
+	void BeginChild();
+	// Finish writing a block of child nodes.
+	void EndChild();
+	// Begin a new section. This only has an effect between top-level nodes.
+	void EndSection();
+	
+	// Get the complete encoded file.
+	std::string Contents() const;
+	
+	
+private:
+	// Decode one section, adding its nodes as children of the given node.
+	static bool DecodeSection(const std::string &data, size_t pos, size_t end, DataNode &root, size_t &lineNumber);
+	// Decode a block of nodes, adding them as children of the given node.
+	static bool DecodeBlock(const std::string &data, size_t pos, size_t end,
+		const std::vector<std::string> &strings, DataNode &parent, size_t &lineNumber);
+	// Get the encoded string table and nodes of the section being written.
+	std::string Section() const;
+	
+	
+private:
+	// The sections that are finished, each stored with its length.
+	std::string sections;
+	// Index of each distinct string token in the section that is being
+	// written, and the string table in order.
+	std::unordered_map<std::string, size_t> index;
+	std::vector<const std::string *> strings;
+	// The encoded nodes at each level of nesting that is not finished yet.
+	std::vector<std::string> blocks;
+	// Whether the last node in each of those blocks is still waiting for its
+	// block of children, which might turn out to be empty.
+	std::vector<bool> waiting;
+	// Whether the node that is being written has any tokens yet.
+	bool hasTokens = false;
+};
+
+
+
+#endif
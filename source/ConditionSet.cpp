@@ -147,33 +147,24 @@ namespace {
 		return false;
 	}
 	
-	// Converts the given vector of condition tokens (like "reputation: Republic",
-	// "random", or "4") into the integral values they have at runtime.
-	vector<int64_t> SubstituteValues(const vector<string> &side, const map<string, int64_t> &conditions, const map<string, int64_t> &created)
+	// Program step IDs that do not refer to a condition.
+	const int RANDOM = -1;
+	const int CONSTANT = -2;
+	
+	// Find the temporary condition with the given ID, if it has been created.
+	template <class T>
+	auto FindCreated(T &created, int id) -> decltype(&created.front().second)
 	{
-		auto result = vector<int64_t>();
-		result.reserve(side.size());
-		for(const string &str : side)
-		{
-			int64_t value = 0;
-			if(str == "random")
-				value = Random::Int(100);
-			else if(DataNode::IsNumber(str))
-				value = static_cast<int64_t>(DataNode::Value(str));
-			else
-			{
-				const auto temp = created.find(str);
-				const auto perm = conditions.find(str);
-				if(temp != created.end())
-					value = temp->second;
-				else if(perm != conditions.end())
-					value = perm->second;
-			}
-			result.emplace_back(value);
-		}
-		return result;
+		for(auto &it : created)
+			if(it.first == id)
+				return &it.second;
+		return nullptr;
 	}
 	
+	// Programs never need more than this many values on the evaluation stack,
+	// unless an expression has dozens of nested parentheses.
+	const size_t MAX_STACK = 32;
+	
 	bool UsedAll(const vector<bool> &status)
 	{
 		for(auto v : status)
@@ -411,7 +402,7 @@ bool ConditionSet::Test(const Conditions &conditions) const
 	// If this ConditionSet contains any expressions with operators that
 	// modify the condition map, then they must be applied before testing,
 	// to generate any temporary conditions needed.
-	Conditions created;
+	Created created;
 	if(hasAssign)
 		TestApply(conditions, created);
 	return TestSet(conditions, created);
@@ -422,7 +413,7 @@ bool ConditionSet::Test(const Conditions &conditions) const
 // Modify the given set of conditions.
 void ConditionSet::Apply(Conditions &conditions) const
 {
-	Conditions unused;
+	Created unused;
 	for(const Expression &expression : expressions)
 		if(!expression.IsTestable())
 			expression.Apply(conditions, unused);
@@ -434,7 +425,7 @@ void ConditionSet::Apply(Conditions &conditions) const
 
 
 // Check if this set is satisfied by either the created, temporary conditions, or the given conditions.
-bool ConditionSet::TestSet(const Conditions &conditions, const Conditions &created) const
+bool ConditionSet::TestSet(const Conditions &conditions, const Created &created) const
 {
 	// Not all expressions may be testable: some may have been used to form the "created" condition map.
 	for(const Expression &expression : expressions)
@@ -462,7 +453,7 @@ bool ConditionSet::TestSet(const Conditions &conditions, const Conditions &creat
 
 // Construct new, temporary conditions based on the assignment expressions in
 // this ConditionSet and the values in the player's conditions map.
-void ConditionSet::TestApply(const Conditions &conditions, Conditions &created) const
+void ConditionSet::TestApply(const Conditions &conditions, Created &created) const
 {
 	for(const Expression &expression : expressions)
 		if(!expression.IsTestable())
@@ -478,6 +469,8 @@ void ConditionSet::TestApply(const Conditions &conditions, Conditions &created)
 ConditionSet::Expression::Expression(const vector<string> &left, const string &op, const vector<string> &right)
 	: op(op), fun(Op(op)), left(left), right(right)
 {
+	if(!IsTestable() && !this->left.IsEmpty())
+		id = ConditionsStore::Id(Name());
 }
 
 
@@ -486,6 +479,8 @@ ConditionSet::Expression::Expression(const vector<string> &left, const string &o
 ConditionSet::Expression::Expression(const string &left, const string &op, const string &right)
 	: op(op), fun(Op(op)), left(left), right(right)
 {
+	if(!IsTestable() && !this->left.IsEmpty())
+		id = ConditionsStore::Id(Name());
 }
 
 
@@ -536,7 +531,7 @@ bool ConditionSet::Expression::IsTestable() const
 
 
 // Evaluate both the left- and right-hand sides of the expression, then compare the evaluated numeric values.
-bool ConditionSet::Expression::Test(const Conditions &conditions, const Conditions &created) const
+bool ConditionSet::Expression::Test(const Conditions &conditions, const Created &created) const
 {
 	int64_t lhs = left.Evaluate(conditions, created);
 	int64_t rhs = right.Evaluate(conditions, created);
@@ -546,9 +541,9 @@ bool ConditionSet::Expression::Test(const Conditions &conditions, const Conditio
 
 
 // Assign the computed value to the desired condition.
-void ConditionSet::Expression::Apply(Conditions &conditions, Conditions &created) const
+void ConditionSet::Expression::Apply(Conditions &conditions, Created &created) const
 {
-	int64_t &c = conditions[Name()];
+	int64_t &c = conditions[id];
 	int64_t value = right.Evaluate(conditions, created);
 	c = fun(c, value);
 }
@@ -556,11 +551,16 @@ void ConditionSet::Expression::Apply(Conditions &conditions, Conditions &created
 
 
 // Assign the computed value to the desired temporary condition.
-void ConditionSet::Expression::TestApply(const Conditions &conditions, Conditions &created) const
+void ConditionSet::Expression::TestApply(const Conditions &conditions, Created &created) const
 {
-	int64_t &c = created[Name()];
+	int64_t *c = FindCreated(created, id);
+	if(!c)
+	{
+		created.emplace_back(id, 0);
+		c = &created.back().second;
+	}
 	int64_t value = right.Evaluate(conditions, created);
-	c = fun(c, value);
+	*c = fun(*c, value);
 }
 
 
@@ -573,6 +573,7 @@ ConditionSet::Expression::SubExpression::SubExpression(const vector<string> &sid
 	
 	ParseSide(side);
 	GenerateSequence();
+	Compile();
 }
 
 
@@ -582,6 +583,7 @@ ConditionSet::Expression::SubExpression::SubExpression(const vector<string> &sid
 ConditionSet::Expression::SubExpression::SubExpression(const string &side)
 {
 	tokens.emplace_back(side.empty() ? "'" : side);
+	Compile();
 }
 
 
@@ -641,26 +643,30 @@ bool ConditionSet::Expression::SubExpression::IsEmpty() const
 
 
 
-// Evaluate the SubExpression using the given condition maps.
-int64_t ConditionSet::Expression::SubExpression::Evaluate(const Conditions &conditions, const Conditions &created) const
+// Evaluate the SubExpression using the given condition maps, by running its
+// program on a small stack. No memory is allocated while doing so.
+int64_t ConditionSet::Expression::SubExpression::Evaluate(const Conditions &conditions, const Created &created) const
 {
-	// Sanity check.
-	if(tokens.empty())
-		return 0;
-	
-	// For SubExpressions with no Operations (i.e. simple conditions), tokens will consist
-	// of only the condition or numeric value to be returned as-is after substitution.
-	auto data = SubstituteValues(tokens, conditions, created);
-	
-	if(!sequence.empty())
+	int64_t stack[MAX_STACK];
+	size_t size = 0;
+	for(const Step &step : program)
 	{
-		// Each Operation adds to the end of the data vector.
-		data.reserve(operatorCount + data.size());
-		for(const Operation &op : sequence)
-			data.emplace_back(op.fun(data[op.a], data[op.b]));
+		if(step.fun)
+		{
+			--size;
+			stack[size - 1] = step.fun(stack[size - 1], stack[size]);
+		}
+		else if(step.id == CONSTANT)
+			stack[size++] = step.value;
+		else if(step.id == RANDOM)
+			stack[size++] = Random::Int(100);
+		else
+		{
+			const int64_t *temp = FindCreated(created, step.id);
+			stack[size++] = temp ? *temp : conditions.Get(step.id);
+		}
 	}
-	
-	return data.back();
+	return size ? stack[0] : 0;
 }
 
 
@@ -821,3 +827,71 @@ ConditionSet::Expression::SubExpression::Operation::Operation(const string &op,
 	: fun(Op(op)), a(a), b(b)
 {
 }
+
+
+
+// Compile the tokens and the sequence of Operations into a postfix program. The
+// result of the last Operation (or the last token, if there are none) is the
+// value of this SubExpression.
+void ConditionSet::Expression::SubExpression::Compile()
+{
+	program.clear();
+	if(tokens.empty())
+		return;
+	
+	CompileValue(sequence.empty() ? tokens.size() - 1 : tokens.size() + sequence.size() - 1);
+	vector<Operation>().swap(sequence);
+	
+	// Make sure the program cannot overflow the evaluation stack.
+	size_t size = 0;
+	size_t maxSize = 0;
+	for(const Step &step : program)
+	{
+		size = step.fun ? size - 1 : size + 1;
+		maxSize = max(maxSize, size);
+	}
+	if(maxSize > MAX_STACK)
+	{
+		Files::LogError("Condition expression is too deeply nested:");
+		PrintConditionError(ToStrings());
+		program.clear();
+	}
+}
+
+
+
+// Add the steps that compute the given value to the program. Values below the
+// number of tokens are the tokens themselves, and the rest are the results of
+// each Operation in the sequence.
+void ConditionSet::Expression::SubExpression::CompileValue(size_t index)
+{
+	if(index >= tokens.size())
+	{
+		const Operation &operation = sequence[index - tokens.size()];
+		CompileValue(operation.a);
+		CompileValue(operation.b);
+		
+		// If both operands are constants, do the operation now instead. (A
+		// division or modulus by zero is left to be done at runtime.)
+		size_t size = program.size();
+		if(program[size - 2].id == CONSTANT && !program[size - 2].fun
+				&& program[size - 1].id == CONSTANT && !program[size - 1].fun && program[size - 1].value)
+		{
+			program[size - 2].value = operation.fun(program[size - 2].value, program[size - 1].value);
+			program.pop_back();
+		}
+		else
+			program.push_back(Step{operation.fun, 0, 0});
+		return;
+	}
+	
+	const string &token = tokens[index];
+	if(token == "random")
+		program.push_back(Step{nullptr, RANDOM, 0});
+	else if(DataNode::IsNumber(token))
+		program.push_back(Step{nullptr, CONSTANT, static_cast<int64_t>(DataNode::Value(token))});
+	else if(token.empty())
+		program.push_back(Step{nullptr, CONSTANT, 0});
+	else
+		program.push_back(Step{nullptr, ConditionsStore::Id(token), 0});
+}
@@ -13,8 +13,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef CONDITION_SET_H_
 #define CONDITION_SET_H_
 
-#include <map>
+#include "ConditionsStore.h"
+
 #include <string>
+#include <utility>
 #include <vector>
 
 class DataNode;
@@ -28,7 +30,7 @@ class DataWriter;
 // values.
 class ConditionSet {
 public:
-	using Conditions = std::map<std::string, int64_t>;
+	using Conditions = ConditionsStore;
 	ConditionSet() = default;
 	// Construct and Load() at the same time.
 	ConditionSet(const DataNode &node);
@@ -60,10 +62,14 @@ public:
 	
 	
 private:
+	// Temporary conditions created while testing a set, by condition ID. There
+	// are usually only a few, so they are kept in a short list.
+	using Created = std::vector<std::pair<int, int64_t>>;
+	
 	// Compare this set's expressions and the union of created and supplied conditions.
-	bool TestSet(const Conditions &conditions, const Conditions &created) const;
+	bool TestSet(const Conditions &conditions, const Created &created) const;
 	// Evaluate this set's assignment expressions and store the result in "created" (for use by TestSet).
-	void TestApply(const Conditions &conditions, Conditions &created) const;
+	void TestApply(const Conditions &conditions, Created &created) const;
 	
 	
 private:
@@ -87,16 +93,17 @@ private:
 		bool IsTestable() const;
 		
 		// Functions to use this expression:
-		bool Test(const Conditions &conditions, const Conditions &created) const;
-		void Apply(Conditions &conditions, Conditions &created) const;
-		void TestApply(const Conditions &conditions, Conditions &created) const;
+		bool Test(const Conditions &conditions, const Created &created) const;
+		void Apply(Conditions &conditions, Created &created) const;
+		void TestApply(const Conditions &conditions, Created &created) const;
 		
 		
 	private:
 		// A SubExpression results from applying operator-precedence parsing to one side of
 		// an Expression. The operators and tokens needed to recreate the given side are
 		// stored, and can be interleaved to restore the original string. Based on them, a
-		// sequence of "Operations" is created for runtime evaluation.
+		// sequence of "Operations" is created and then compiled into a postfix program
+		// for runtime evaluation.
 		class SubExpression {
 		public:
 			SubExpression(const std::vector<std::string> &side);
@@ -109,14 +116,17 @@ private:
 			
 			bool IsEmpty() const;
 			
-			// Substitute numbers for any string values and then compute the result.
-			int64_t Evaluate(const Conditions &conditions, const Conditions &created) const;
+			// Run the compiled program to compute the result.
+			int64_t Evaluate(const Conditions &conditions, const Created &created) const;
 			
 			
 		private:
 			void ParseSide(const std::vector<std::string> &side);
 			void GenerateSequence();
 			bool AddOperation(std::vector<int> &data, size_t &index, const size_t &opIndex);
+			// Convert the tokens and sequence of Operations into the program.
+			void Compile();
+			void CompileValue(size_t index);
 			
 			
 		private:
@@ -131,10 +141,24 @@ private:
 				size_t b;
 			};
 			
+			// Each Step of the program either pushes a value onto the evaluation
+			// stack, or replaces the top two values with the result of a function.
+			// A pushed value is a condition, a constant, or a random number.
+			class Step {
+			public:
+				int64_t (*fun)(int64_t, int64_t);
+				int id;
+				int64_t value;
+			};
+			
 			
 		private:
-			// Iteration of the sequence vector yields the result.
+			// Iteration of the sequence vector yields the result. It is only
+			// needed until the program has been compiled.
 			std::vector<Operation> sequence;
+			// The compiled program, with condition names already resolved to IDs
+			// and any operations on constants already done.
+			std::vector<Step> program;
 			// The tokens vector converts into a data vector of numeric values during evaluation.
 			std::vector<std::string> tokens;
 			std::vector<std::string> operators;
@@ -153,6 +177,8 @@ private:
 		// SubExpressions contain one or more tokens and any number of simple operators.
 		SubExpression left;
 		SubExpression right;
+		// The ID of the condition that an assignment expression modifies.
+		int id = -1;
 	};
 	
 	
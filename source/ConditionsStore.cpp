@@ -0,0 +1,215 @@
+/* ConditionsStore.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "ConditionsStore.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+	// Every condition name that has been seen, and its ID.
+	unordered_map<string, int> ids;
+	vector<const string *> names;
+	// For each prefix that has been asked for, the IDs of all the names that
+	// begin with it, kept in alphabetical order. There are only ever a handful
+	// of these, such as "salary: " and "tribute: ".
+	map<string, vector<int>> prefixes;
+	
+	bool NameLess(int a, int b)
+	{
+		return *names[a] < *names[b];
+	}
+	
+	const vector<int> &WithPrefix(const string &prefix)
+	{
+		auto it = prefixes.find(prefix);
+		if(it != prefixes.end())
+			return it->second;
+		
+		vector<int> &list = prefixes[prefix];
+		for(size_t id = 0; id < names.size(); ++id)
+			if(!names[id]->compare(0, prefix.length(), prefix))
+				list.push_back(id);
+		sort(list.begin(), list.end(), NameLess);
+		return list;
+	}
+}
+
+
+
+// Get the ID of the given condition name, assigning it one if needed.
+int ConditionsStore::Id(const string &name)
+{
+	auto it = ids.find(name);
+	if(it != ids.end())
+		return it->second;
+	
+	int id = names.size();
+	it = ids.emplace(name, id).first;
+	names.push_back(&it->first);
+	for(auto &pit : prefixes)
+		if(!name.compare(0, pit.first.length(), pit.first))
+			pit.second.insert(upper_bound(pit.second.begin(), pit.second.end(), id, NameLess), id);
+	return id;
+}
+
+
+
+// Get the ID of the given name, or -1 if it has never been used.
+int ConditionsStore::Find(const string &name)
+{
+	auto it = ids.find(name);
+	return (it == ids.end() ? -1 : it->second);
+}
+
+
+
+// Get the name of the condition with the given ID.
+const string &ConditionsStore::Name(int id)
+{
+	return *names[id];
+}
+
+
+
+ConditionsStore::ConditionsStore(initializer_list<pair<string, int64_t>> init)
+{
+	for(const auto &it : init)
+		(*this)[it.first] = it.second;
+}
+
+
+
+// Check whether any conditions are set.
+bool ConditionsStore::IsEmpty() const
+{
+	return !count;
+}
+
+
+
+// Get the number of conditions that are set.
+int ConditionsStore::Size() const
+{
+	return count;
+}
+
+
+
+// Check whether the given condition is set (even if its value is zero).
+bool ConditionsStore::Has(int id) const
+{
+	return id >= 0 && static_cast<size_t>(id) < isSet.size() && isSet[id];
+}
+
+
+
+bool ConditionsStore::Has(const string &name) const
+{
+	return Has(Find(name));
+}
+
+
+
+// Get the value of the given condition, which is zero if it is not set.
+int64_t ConditionsStore::Get(int id) const
+{
+	return (id >= 0 && static_cast<size_t>(id) < values.size()) ? values[id] : 0;
+}
+
+
+
+int64_t ConditionsStore::Get(const string &name) const
+{
+	return Get(Find(name));
+}
+
+
+
+// Get a reference to the given condition's value, setting it if it was not.
+int64_t &ConditionsStore::operator[](int id)
+{
+	if(static_cast<size_t>(id) >= values.size())
+	{
+		// Leave room for the names that will be added after this one.
+		size_t size = max<size_t>(id + 1, names.size());
+		values.resize(size);
+		isSet.resize(size);
+	}
+	if(!isSet[id])
+	{
+		isSet[id] = true;
+		++count;
+	}
+	return values[id];
+}
+
+
+
+int64_t &ConditionsStore::operator[](const string &name)
+{
+	return (*this)[Id(name)];
+}
+
+
+
+// Erase the given condition.
+void ConditionsStore::Erase(int id)
+{
+	if(!Has(id))
+		return;
+	
+	isSet[id] = false;
+	values[id] = 0;
+	--count;
+}
+
+
+
+void ConditionsStore::Erase(const string &name)
+{
+	Erase(Find(name));
+}
+
+
+
+// Erase every condition whose name begins with the given prefix.
+void ConditionsStore::ErasePrefix(const string &prefix)
+{
+	for(int id : WithPrefix(prefix))
+		Erase(id);
+}
+
+
+
+void ConditionsStore::Clear()
+{
+	values.clear();
+	isSet.clear();
+	count = 0;
+}
+
+
+
+// Get the IDs of all the conditions that are set and whose names begin with
+// the given prefix, in alphabetical order of their names.
+vector<int> ConditionsStore::Ids(const string &prefix) const
+{
+	vector<int> result;
+	for(int id : WithPrefix(prefix))
+		if(Has(id))
+			result.push_back(id);
+	return result;
+}
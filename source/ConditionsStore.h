@@ -0,0 +1,78 @@
+/* ConditionsStore.h
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef CONDITIONS_STORE_H_
+#define CONDITIONS_STORE_H_
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+// A set of named conditions, each of which has an integer value. Every distinct
+// condition name is given a small integer ID the first time it is seen, which
+// for most names is while the game data is being loaded. Anything that uses the
+// same condition repeatedly can look up its ID once and then use that to get or
+// set the value directly, without comparing any strings. A condition that has
+// never been set, or that has been erased, has a value of zero.
+class ConditionsStore {
+public:
+	// Get the ID of the given condition name, assigning it one if needed.
+	static int Id(const std::string &name);
+	// Get the ID of the given name, or -1 if it has never been used.
+	static int Find(const std::string &name);
+	// Get the name of the condition with the given ID.
+	static const std::string &Name(int id);
+	
+	
+public:
+	ConditionsStore() = default;
+	ConditionsStore(std::initializer_list<std::pair<std::string, int64_t>> init);
+	
+	// Check whether any conditions are set, or how many are.
+	bool IsEmpty() const;
+	int Size() const;
+	
+	// Check whether the given condition is set (even if its value is zero).
+	bool Has(int id) const;
+	bool Has(const std::string &name) const;
+	// Get the value of the given condition, which is zero if it is not set.
+	int64_t Get(int id) const;
+	int64_t Get(const std::string &name) const;
+	// Get a reference to the given condition's value, setting it if it was not.
+	int64_t &operator[](int id);
+	int64_t &operator[](const std::string &name);
+	
+	// Erase the given condition, or every condition beginning with the prefix.
+	void Erase(int id);
+	void Erase(const std::string &name);
+	void ErasePrefix(const std::string &prefix);
+	void Clear();
+	
+	// Get the IDs of all the conditions that are set and whose names begin with
+	// the given prefix, in alphabetical order of their names.
+	std::vector<int> Ids(const std::string &prefix = std::string()) const;
+	
+	
+private:
+	// The value of each condition, indexed by ID, and which of them are set.
+	std::vector<int64_t> values;
+	std::vector<bool> isSet;
+	int count = 0;
+};
+
+
+
+#endif
@@ -305,9 +305,12 @@ bool Conversation::IsValidIntro() const noexcept
 Conversation Conversation::Substitute(const map<string, string> &subs) const
 {
 	Conversation result = *this;
+	// Most paragraphs have no keys in them at all, and the copy already holds
+	// their text, so only rebuild the ones that might.
 	for(Node &node : result.nodes)
 		for(pair<string, int> &choice : node.data)
-			choice.first = Format::Replace(choice.first, subs);
+			if(choice.first.find('<') != string::npos)
+				choice.first = Format::Replace(choice.first, subs);
 	return result;
 }
 
@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "DataFile.h"
 
+#include "BinaryData.h"
 #include "Files.h"
 #include "text/Utf8.h"
 
@@ -42,10 +43,6 @@ void DataFile::Load(const string &path)
 	if(data.empty())
 		return;
 	
-	// As a sentinel, make sure the file always ends in a newline.
-	if(data.empty() || data.back() != '\n')
-		data.push_back('\n');
-	
 	// Note what file this node is in, so it will show up in error traces.
 	root.tokens.push_back("file");
 	root.tokens.push_back(path);
@@ -68,9 +65,6 @@ void DataFile::Load(istream &in)
 		in.read(&*data.begin() + currentSize, BLOCK);
 		data.resize(currentSize + in.gcount());
 	}
-	// As a sentinel, make sure the file always ends in a newline.
-	if(data.empty() || data.back() != '\n')
-		data.push_back('\n');
 	
 	LoadData(data);
 }
@@ -93,9 +87,20 @@ list<DataNode>::const_iterator DataFile::end() const
 
 
 
-// Parse the given text.
-void DataFile::LoadData(const string &data)
+// Parse the given text or binary data.
+void DataFile::LoadData(string &data)
 {
+	if(BinaryData::IsBinary(data))
+	{
+		if(!BinaryData::Decode(data, root))
+			root.PrintTrace("Binary data is not valid:");
+		return;
+	}
+	
+	// As a sentinel, make sure the file always ends in a newline.
+	if(data.empty() || data.back() != '\n')
+		data.push_back('\n');
+	
 	// Keep track of the current stack of indentation levels and the most recent
 	// node at each level - that is, the node that will be the "parent" of any
 	// new node added at the next deeper indentation level.
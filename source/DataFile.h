@@ -26,7 +26,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 // is determined by indentation: if a node is more indented than the node before
 // it, it is a "child" of that node. Otherwise, it is a "sibling." Each node is
 // just a collection of one or more tokens that can be interpreted either as
-// strings or as floating point values; see DataNode for more information.
+// strings or as floating point values; see DataNode for more information. The
+// same nodes may instead be stored in a binary encoding; see BinaryData.
 class DataFile {
 public:
 	// A DataFile can be loaded either from a file path or an istream.
@@ -43,7 +44,7 @@ public:
 	
 	
 private:
-	void LoadData(const std::string &data);
+	void LoadData(std::string &data);
 	
 	
 private:
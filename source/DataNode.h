@@ -77,7 +77,8 @@ private:
 	// The line number in the given file that produced this node.
 	size_t lineNumber = 0;
 	
-	// Allow DataFile to modify the internal structure of DataNodes.
+	// Allow DataFile and BinaryData to modify the internal structure of DataNodes.
+	friend class BinaryData;
 	friend class DataFile;
 };
 
@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "DataWriter.h"
 
+#include "BinaryData.h"
 #include "DataNode.h"
 #include "Files.h"
 
@@ -26,10 +27,22 @@ const string DataWriter::space = " ";
 
 
 // Constructor, specifying the file to save.
-DataWriter::DataWriter(const string &path)
-	: path(path), before(&indent)
+DataWriter::DataWriter(const string &path, Encoding encoding)
+	: DataWriter(encoding)
+{
+	this->path = path;
+}
+
+
+
+// Constructor for composing the file in memory.
+DataWriter::DataWriter(Encoding encoding)
+	: before(&indent)
 {
 	out.precision(8);
+	number.precision(8);
+	if(encoding == Encoding::BINARY)
+		binary.reset(new BinaryData);
 }
 
 
@@ -37,7 +50,13 @@ DataWriter::DataWriter(const string &path)
 // Destructor, which saves the file all in one block.
 DataWriter::~DataWriter()
 {
-	Files::Write(path, out.str());
+	if(path.empty())
+		return;
+	
+	if(binary)
+		Files::WriteAtomically(path, Contents(), true);
+	else
+		Files::Write(path, Contents());
 }
 
 
@@ -46,8 +65,8 @@ DataWriter::~DataWriter()
 void DataWriter::Write(const DataNode &node)
 {
 	// Write all this node's tokens.
-	for(int i = 0; i < node.Size(); ++i)
-		WriteToken(node.Token(i).c_str());
+	for(const string &token : node.Tokens())
+		WriteToken(token);
 	Write();
 	
 	// If this node has any children, call this function recursively on them.
@@ -67,7 +86,10 @@ void DataWriter::Write(const DataNode &node)
 // Begin a new line of the file.
 void DataWriter::Write()
 {
-	out << '\n';
+	if(binary)
+		binary->EndNode();
+	else
+		out << '\n';
 	before = &indent;
 }
 
@@ -76,6 +98,8 @@ void DataWriter::Write()
 // Increase the indentation level.
 void DataWriter::BeginChild()
 {
+	if(binary)
+		binary->BeginChild();
 	indent += '\t';
 }
 
@@ -84,15 +108,27 @@ void DataWriter::BeginChild()
 // Decrease the indentation level.
 void DataWriter::EndChild()
 {
+	if(binary)
+		binary->EndChild();
 	indent.erase(indent.length() - 1);
 }
 
 
 
+// In binary data, begin a new section with its own string table.
+void DataWriter::EndSection()
+{
+	if(binary)
+		binary->EndSection();
+}
+
+
+
 // Write a comment line, at the current indentation level.
 void DataWriter::WriteComment(const string &str)
 {
-	out << indent << "# " << str << '\n';
+	if(!binary)
+		out << indent << "# " << str << '\n';
 }
 
 
@@ -100,6 +136,12 @@ void DataWriter::WriteComment(const string &str)
 // Write a token, given as a character string.
 void DataWriter::WriteToken(const char *a)
 {
+	if(binary)
+	{
+		binary->AddToken(a);
+		return;
+	}
+	
 	// Figure out what kind of quotation marks need to be used for this string.
 	bool hasSpace = !*a;
 	bool hasQuote = false;
@@ -128,5 +170,16 @@ void DataWriter::WriteToken(const char *a)
 // Write a token, given as a string object.
 void DataWriter::WriteToken(const string &a)
 {
-	WriteToken(a.c_str());
+	if(binary)
+		binary->AddToken(a);
+	else
+		WriteToken(a.c_str());
+}
+
+
+
+// Get everything that has been written so far.
+string DataWriter::Contents() const
+{
+	return binary ? binary->Contents() : out.str();
 }
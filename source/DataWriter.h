@@ -15,10 +15,12 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
+class BinaryData;
 class DataNode;
 
 
@@ -28,10 +30,17 @@ class DataNode;
 // using this class, you can have a function add data to the file without having
 // to tell that function what indentation level it is at. This class also
 // automatically adds quotation marks around strings if they contain whitespace.
+// The same data can instead be written in a compact binary encoding.
 class DataWriter {
+public:
+	enum class Encoding {TEXT, BINARY};
+	
+	
 public:
 	// Constructor, specifying the file to write.
-	explicit DataWriter(const std::string &path);
+	explicit DataWriter(const std::string &path, Encoding encoding = Encoding::TEXT);
+	// Constructor for composing the file in memory without writing it.
+	explicit DataWriter(Encoding encoding = Encoding::TEXT);
 	DataWriter(const DataWriter &) = delete;
 	DataWriter(DataWriter &&) = delete;
 	DataWriter &operator=(const DataWriter &) = delete;
@@ -55,9 +64,12 @@ public:
 	void BeginChild();
 	// Finish writing a block of child nodes and decrease the indentation.
 	void EndChild();
+	// In binary data, let everything written so far be read without reading
+	// the rest of the file. This has no effect on text.
+	void EndSection();
 	
 	// Write a comment. It will be at the current indentation level, and will
-	// have "# " inserted before it.
+	// have "# " inserted before it. Comments are not kept in binary data.
 	void WriteComment(const std::string &str);
 	
 	// Write a token, without writing a whole line. Use this very carefully.
@@ -67,6 +79,9 @@ public:
 	template <class A>
 	void WriteToken(const A &a);
 	
+	// Get everything that has been written so far.
+	std::string Contents() const;
+	
 	
 private:
 	// Save path (in UTF-8).
@@ -81,6 +96,10 @@ private:
 	const std::string *before;
 	// Compose the output in memory before writing it to file.
 	std::ostringstream out;
+	// If writing binary data, tokens are added to this instead, with any
+	// numbers first converted to text in exactly the same way.
+	std::unique_ptr<BinaryData> binary;
+	std::ostringstream number;
 };
 
 
@@ -103,6 +122,13 @@ void DataWriter::WriteToken(const A &a)
 	static_assert(std::is_arithmetic<A>::value,
 		"DataWriter cannot output anything but strings and arithmetic types.");
 	
+	if(binary)
+	{
+		number.str(std::string());
+		number << a;
+		WriteToken(number.str());
+		return;
+	}
 	out << *before << a;
 	before = &space;
 }
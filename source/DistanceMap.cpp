@@ -12,22 +12,148 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "DistanceMap.h"
 
+#include "GameData.h"
 #include "Planet.h"
 #include "PlayerInfo.h"
+#include "Set.h"
 #include "Ship.h"
 #include "StellarObject.h"
 #include "System.h"
 
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 using namespace std;
 
 
 
+// The number of hyperspace jumps between every pair of systems. Each system's
+// row of the table is only filled in the first time that system is the center
+// of a distance map, and the whole table is thrown out if any links change.
+class DistanceMap::HopTable {
+public:
+	HopTable();
+	
+	// Get the index of the given system, or -1 if it is not in the table.
+	int Index(const System *system) const;
+	const System *GetSystem(int index) const;
+	int Size() const;
+	// Get the distances from the given system to all the others.
+	const Hop *From(const System *center);
+	
+	
+private:
+	vector<const System *> systems;
+	unordered_map<const System *, int> indices;
+	vector<vector<Hop>> rows;
+	mutex rowMutex;
+};
+
+
+
+namespace {
+	// Protects the shared table, but not its contents.
+	mutex hopTableMutex;
+	// This is incremented each time the shared table is discarded.
+	int hopTableVersion = 0;
+}
+
+
+
+DistanceMap::HopTable::HopTable()
+{
+	for(const auto &it : GameData::Systems())
+	{
+		indices[&it.second] = systems.size();
+		systems.push_back(&it.second);
+	}
+	rows.resize(systems.size());
+}
+
+
+
+int DistanceMap::HopTable::Index(const System *system) const
+{
+	auto it = indices.find(system);
+	return (it == indices.end() ? -1 : it->second);
+}
+
+
+
+const System *DistanceMap::HopTable::GetSystem(int index) const
+{
+	return systems[index];
+}
+
+
+
+int DistanceMap::HopTable::Size() const
+{
+	return systems.size();
+}
+
+
+
+// Get the distances from the given system to all the others. Since every link
+// costs the same, a breadth-first search finds the same distances that the
+// route search would.
+const DistanceMap::Hop *DistanceMap::HopTable::From(const System *center)
+{
+	int first = Index(center);
+	if(first < 0)
+		return nullptr;
+	
+	lock_guard<mutex> lock(rowMutex);
+	vector<Hop> &row = rows[first];
+	if(row.empty())
+	{
+		row.resize(systems.size());
+		row[first].days = 0;
+		vector<int> queue(1, first);
+		for(size_t i = 0; i < queue.size(); ++i)
+		{
+			int from = queue[i];
+			for(const System *link : systems[from]->Links())
+			{
+				int to = Index(link);
+				if(to < 0 || row[to].days >= 0)
+					continue;
+				
+				row[to].days = row[from].days + 1;
+				row[to].previous = from;
+				queue.push_back(to);
+			}
+		}
+	}
+	return row.data();
+}
+
+
+
 // Find paths to the given system. If the given maximum count is above zero,
 // it is a limit on how many systems should be returned. If it is below zero
 // it specifies the maximum distance away that paths should be found.
 DistanceMap::DistanceMap(const System *center, int maxCount, int maxDistance)
 	: center(center), maxCount(maxCount), maxDistance(maxDistance), useWormholes(false)
 {
+	// Unless the search must stop after a certain number of systems, look up
+	// the distances in the shared table instead.
+	if(center && maxCount < 0)
+	{
+		{
+			lock_guard<mutex> lock(hopTableMutex);
+			shared_ptr<HopTable> &table = SharedHopTable();
+			if(!table)
+				table.reset(new HopTable());
+			hops = table;
+		}
+		row = hops->From(center);
+		if(row)
+			return;
+		hops.reset();
+	}
 	Init();
 }
 
@@ -73,9 +199,51 @@ DistanceMap::DistanceMap(const Ship &ship, const System *destination)
 
 
 
+// Discard the cached distances along hyperspace links. This must be done
+// whenever the links between systems change.
+void DistanceMap::ClearCache()
+{
+	lock_guard<mutex> lock(hopTableMutex);
+	SharedHopTable().reset();
+	++hopTableVersion;
+}
+
+
+
+// Get the number of jumps along hyperspace links between the given systems.
+int DistanceMap::Jumps(const System *from, const System *to)
+{
+	lock_guard<mutex> lock(hopTableMutex);
+	shared_ptr<HopTable> &table = SharedHopTable();
+	if(!table)
+		table.reset(new HopTable());
+	
+	// Many systems are usually checked against the same one in a row, so
+	// remember which row of the table was used last.
+	static const System *previous = nullptr;
+	static const Hop *row = nullptr;
+	static int version = -1;
+	if(from != previous || version != hopTableVersion)
+	{
+		previous = from;
+		row = table->From(from);
+		version = hopTableVersion;
+	}
+	if(!row)
+		return -1;
+	
+	int index = table->Index(to);
+	return (index < 0 ? -1 : row[index].days);
+}
+
+
+
 // Find out if the given system is reachable.
 bool DistanceMap::HasRoute(const System *system) const
 {
+	if(row)
+		return (Days(system) >= 0);
+	
 	return route.count(system);
 }
 
@@ -84,6 +252,13 @@ bool DistanceMap::HasRoute(const System *system) const
 // Find out how many days away the given system is.
 int DistanceMap::Days(const System *system) const
 {
+	if(row)
+	{
+		int index = hops->Index(system);
+		int days = (index < 0 ? -1 : row[index].days);
+		return ((maxDistance >= 0 && days > maxDistance) ? -1 : days);
+	}
+	
 	auto it = route.find(system);
 	return (it == route.end() ? -1 : it->second.days);
 }
@@ -93,6 +268,14 @@ int DistanceMap::Days(const System *system) const
 // Starting in the given system, what is the next system along the route?
 const System *DistanceMap::Route(const System *system) const
 {
+	if(row)
+	{
+		if(Days(system) < 0)
+			return nullptr;
+		int previous = row[hops->Index(system)].previous;
+		return (previous < 0 ? nullptr : hops->GetSystem(previous));
+	}
+	
 	auto it = route.find(system);
 	return (it == route.end() ? nullptr : it->second.next);
 }
@@ -103,6 +286,14 @@ const System *DistanceMap::Route(const System *system) const
 set<const System *> DistanceMap::Systems() const
 {
 	set<const System *> systems;
+	if(row)
+	{
+		for(int i = 0; i < hops->Size(); ++i)
+			if(row[i].days >= 0 && (maxDistance < 0 || row[i].days <= maxDistance))
+				systems.insert(hops->GetSystem(i));
+		return systems;
+	}
+	
 	for(const auto &it : route)
 		systems.insert(it.first);
 	return systems;
@@ -120,6 +311,15 @@ const System *DistanceMap::End() const
 
 int DistanceMap::RequiredFuel(const System *system1, const System *system2) const
 {
+	if(row)
+	{
+		int days1 = Days(system1);
+		int days2 = Days(system2);
+		if(days1 < 0 || days2 < 0)
+			return -1;
+		return abs(days1 - days2) * hyperspaceFuel;
+	}
+	
 	auto it1 = route.find(system1);
 	auto it2 = route.find(system2);
 	if(it1 == route.end() || it2 == route.end())
@@ -129,6 +329,16 @@ int DistanceMap::RequiredFuel(const System *system1, const System *system2) cons
 
 
 
+// The table of hyperspace link distances that new maps will use. Maps that are
+// already using a table keep it alive even if this one is replaced.
+shared_ptr<DistanceMap::HopTable> &DistanceMap::SharedHopTable()
+{
+	static shared_ptr<HopTable> table;
+	return table;
+}
+
+
+
 DistanceMap::Edge::Edge(const System *system)
 	: next(system)
 {
@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #define DISTANCE_MAP_H_
 
 #include <map>
+#include <memory>
 #include <queue>
 #include <set>
 #include <utility>
@@ -43,6 +44,14 @@ public:
 	// pathfinding will stop once a path to the destination is found.
 	DistanceMap(const Ship &ship, const System *destination);
 	
+	// Discard the cached distances along hyperspace links. This must be done
+	// whenever the links between systems change.
+	static void ClearCache();
+	// Get the number of jumps along hyperspace links between the given systems,
+	// or -1 if there is no route. This is much faster than making a map when
+	// only one distance is needed.
+	static int Jumps(const System *from, const System *to);
+	
 	// Find out if the given system is reachable.
 	bool HasRoute(const System *system) const;
 	// Find out how many days away the given system is.
@@ -77,8 +86,19 @@ private:
 		double danger = 0.;
 	};
 	
+	// A system's distance from the center, and the index of the system before
+	// it on the route, in the shared table of hyperspace link distances.
+	struct Hop {
+		int days = -1;
+		int previous = -1;
+	};
+	class HopTable;
+	
 	
 private:
+	// Get the table of distances that new maps should use.
+	static std::shared_ptr<HopTable> &SharedHopTable();
+	
 	// Depending on the capabilities of the given ship, use hyperspace paths,
 	// jump drive paths, or both to find the shortest route. Bail out if the
 	// source system or the maximum count is reached.
@@ -97,6 +117,11 @@ private:
 	
 private:
 	std::map<const System *, Edge> route;
+	// A map with only a center and a maximum distance, which does not need to
+	// stop after finding a certain number of systems, gets its distances from
+	// the shared table instead of from a route search.
+	std::shared_ptr<HopTable> hops;
+	const Hop *row = nullptr;
 	
 	// Variables only used during construction:
 	std::priority_queue<Edge> edges;
@@ -29,6 +29,7 @@ using namespace std;
 void DrawList::Clear(int step, double zoom)
 {
 	items.clear();
+	sprites.clear();
 	this->step = step;
 	this->zoom = zoom;
 	isHighDPI = (Screen::IsHighResolution() ? zoom > .5 : zoom > 1.);
@@ -102,9 +103,15 @@ void DrawList::Draw() const
 {
 	SpriteShader::Bind();
 	
+	// A sprite's texture only changes when it is uploaded or evicted, which
+	// happens in this thread, so it is looked up here rather than in Push().
 	bool withBlur = Preferences::Has("Render motion blur");
-	for(const SpriteShader::Item &item : items)
+	for(size_t i = 0; i < items.size(); ++i)
+	{
+		SpriteShader::Item item = items[i];
+		item.texture = sprites[i]->Texture(isHighDPI);
 		SpriteShader::Add(item, withBlur);
+	}
 	
 	SpriteShader::Unbind();
 }
@@ -138,7 +145,6 @@ void DrawList::Push(const Body &body, Point pos, Point blur, double cloak, doubl
 {
 	SpriteShader::Item item;
 	
-	item.texture = body.GetSprite()->Texture(isHighDPI);
 	item.frame = body.GetFrame(step);
 	item.frameCount = body.GetSprite()->Frames();
 	
@@ -177,4 +183,5 @@ void DrawList::Push(const Body &body, Point pos, Point blur, double cloak, doubl
 	item.swizzle = swizzle;
 	
 	items.push_back(item);
+	sprites.push_back(body.GetSprite());
 }
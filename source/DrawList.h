@@ -60,6 +60,8 @@ private:
 	double zoom = 1.;
 	bool isHighDPI = false;
 	std::vector<SpriteShader::Item> items;
+	// The sprite each item is drawn with. Its texture is filled in when drawing.
+	std::vector<const Sprite *> sprites;
 	
 	Point center;
 	Point centerVelocity;
@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Engine.h"
 
 #include "Audio.h"
+#include "BatchShader.h"
 #include "CategoryTypes.h"
 #include "CoreStartData.h"
 #include "Effect.h"
@@ -525,6 +526,23 @@ void Engine::Step(bool isActive)
 		player.TravelPlan().push_back(flagship->GetTargetSystem());
 	if(player.HasTravelPlan() && currentSystem == player.TravelPlan().back())
 		player.PopTravel();
+	
+	// Start loading anything that will be needed in the next system of the
+	// travel plan, or on the planet that the flagship is approaching, so that
+	// neither the jump nor the landing has to wait for it.
+	const System *nextSystem = player.HasTravelPlan() ? player.TravelPlan().back() : nullptr;
+	if(nextSystem != prefetchedSystem)
+	{
+		GameData::Prefetch(nextSystem);
+		prefetchedSystem = nextSystem;
+	}
+	const StellarObject *targetStellar = flagship ? flagship->GetTargetStellar() : nullptr;
+	if(targetStellar != prefetchedStellar)
+	{
+		if(targetStellar && targetStellar->HasValidPlanet())
+			GameData::Preload(targetStellar->GetPlanet()->Landscape());
+		prefetchedStellar = targetStellar;
+	}
 	if(doFlash)
 	{
 		flash = .4;
@@ -1059,7 +1077,20 @@ void Engine::Draw() const
 		Color color = *colors.Get("medium");
 		font.Draw(loadString,
 			Point(-10 - font.Width(loadString), Screen::Height() * -.5 + 5.), color);
-	}
+		// Show how many texture binds and draw calls it took to draw all the
+		// projectiles and effects in this frame.
+		string batchString = to_string(BatchShader::Binds()) + " binds, "
+			+ to_string(BatchShader::DrawCalls()) + " batch draws";
+		font.Draw(batchString,
+			Point(-10 - font.Width(batchString), Screen::Height() * -.5 + 25.), color);
+		// Show how many sounds are playing, and how many could not be played
+		// because too many sounds were playing at once.
+		string voiceString = to_string(Audio::ActiveVoices()) + " voices, "
+			+ to_string(Audio::DroppedVoices()) + " dropped";
+		font.Draw(voiceString,
+			Point(-10 - font.Width(voiceString), Screen::Height() * -.5 + 45.), color);
+	}
+	BatchShader::ResetCounts();
 }
 
 
@@ -1323,8 +1354,10 @@ void Engine::CalculateStep()
 	{
 		bool isJumping = flagship->IsUsingJumpDrive();
 		const map<const Sound *, int> &jumpSounds = isJumping ? flagship->Attributes().JumpSounds() : flagship->Attributes().HyperSounds();
+		static const Sound *jumpDriveSound = Audio::Get("jump drive");
+		static const Sound *hyperdriveSound = Audio::Get("hyperdrive");
 		if(jumpSounds.empty())
-			Audio::Play(Audio::Get(isJumping ? "jump drive" : "hyperdrive"));
+			Audio::Play(isJumping ? jumpDriveSound : hyperdriveSound);
 		else
 			for(const auto &sound : jumpSounds)
 				Audio::Play(sound.first);
@@ -1542,6 +1575,12 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 	// the system. Make no sound if it entered via wormhole.
 	if(ship.get() != flagship && ship->Zoom() == 1.)
 	{
+		// The default sounds are only looked up once, because looking up a
+		// sound must wait for the sound loading thread.
+		static const Sound *jumpOutSound = Audio::Get("jump out");
+		static const Sound *hyperdriveOutSound = Audio::Get("hyperdrive out");
+		static const Sound *jumpInSound = Audio::Get("jump in");
+		static const Sound *hyperdriveInSound = Audio::Get("hyperdrive in");
 		// The position from where sounds will be played.
 		Point position = ship->Position();
 		// Did this ship just begin hyperspacing?
@@ -1549,7 +1588,7 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 		{
 			const map<const Sound *, int> &jumpSounds = isJump ? ship->Attributes().JumpOutSounds() : ship->Attributes().HyperOutSounds();
 			if(jumpSounds.empty())
-				Audio::Play(Audio::Get(isJump ? "jump out" : "hyperdrive out"), position);
+				Audio::Play(isJump ? jumpOutSound : hyperdriveOutSound, position);
 			else
 				for(const auto &sound : jumpSounds)
 					Audio::Play(sound.first, position);
@@ -1560,7 +1599,7 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 		{
 			const map<const Sound *, int> &jumpSounds = isJump ? ship->Attributes().JumpInSounds() : ship->Attributes().HyperInSounds();
 			if(jumpSounds.empty())
-				Audio::Play(Audio::Get(isJump ? "jump in" : "hyperdrive in"), position);
+				Audio::Play(isJump ? jumpInSound : hyperdriveInSound, position);
 			else
 				for(const auto &sound : jumpSounds)
 					Audio::Play(sound.first, position);
@@ -2203,8 +2242,9 @@ void Engine::FillRadar()
 		--alarmTime;
 	else if(hasHostiles && !hadHostiles)
 	{
+		static const Sound *alarmSound = Audio::Get("alarm");
 		if(Preferences::Has("Warning siren"))
-			Audio::Play(Audio::Get("alarm"));
+			Audio::Play(alarmSound);
 		alarmTime = 180;
 		hadHostiles = true;
 	}
@@ -43,6 +43,8 @@ class Projectile;
 class Ship;
 class ShipEvent;
 class Sprite;
+class StellarObject;
+class System;
 class Visual;
 class Weather;
 
@@ -189,6 +191,9 @@ private:
 	std::vector<std::pair<const Outfit *, int>> ammo;
 	int jumpCount = 0;
 	const System *jumpInProgress[2] = {nullptr, nullptr};
+	// The system and stellar object whose sprites were most recently prefetched.
+	const System *prefetchedSystem = nullptr;
+	const StellarObject *prefetchedStellar = nullptr;
 	const Sprite *highlightSprite = nullptr;
 	Point highlightUnit;
 	float highlightFrame = 0.f;
@@ -472,6 +472,18 @@ FILE *Files::Open(const string &path, bool write)
 
 
 
+// Open a file for appending binary data to it, creating it if necessary.
+FILE *Files::OpenAppend(const string &path)
+{
+#if defined _WIN32
+	return _wfopen(Utf8::ToUTF16(path).c_str(), L"ab");
+#else
+	return fopen(path.c_str(), "ab");
+#endif
+}
+
+
+
 string Files::Read(const string &path)
 {
 	File file(path);
@@ -524,6 +536,31 @@ void Files::Write(FILE *file, const string &data)
 
 
 
+// Write the data to a temporary file and then replace the given file with it.
+bool Files::WriteAtomically(const string &path, const string &data, bool binary)
+{
+	string temporary = path + ".tmp";
+	// On Windows, binary data must not be written in text mode, which would
+	// turn every byte that happens to be a newline into two bytes.
+#if defined _WIN32
+	FILE *file = _wfopen(Utf8::ToUTF16(temporary).c_str(), binary ? L"wb" : L"w");
+#else
+	FILE *file = fopen(temporary.c_str(), "wb");
+#endif
+	if(!file)
+		return false;
+	
+	bool success = (fwrite(data.data(), 1, data.size(), file) == data.size());
+	success &= !fclose(file);
+	if(success)
+		Move(temporary, path);
+	else
+		Delete(temporary);
+	return success && Exists(path) && !Exists(temporary);
+}
+
+
+
 void Files::LogError(const string &message)
 {
 	lock_guard<mutex> lock(errorMutex);
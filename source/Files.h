@@ -59,10 +59,17 @@ public:
 	
 	// File IO.
 	static FILE *Open(const std::string &path, bool write = false);
+	// Open a file for appending binary data to it, creating it if necessary.
+	static FILE *OpenAppend(const std::string &path);
 	static std::string Read(const std::string &path);
 	static std::string Read(FILE *file);
 	static void Write(const std::string &path, const std::string &data);
 	static void Write(FILE *file, const std::string &data);
+	// Write the data to a temporary file and then replace the given file with
+	// it, so that the file is never left partly written. Binary data is written
+	// exactly as given, even on Windows. Return false if the data could not be
+	// written.
+	static bool WriteAtomically(const std::string &path, const std::string &data, bool binary = false);
 	
 	static void LogError(const std::string &message);
 };
@@ -570,6 +570,19 @@ int64_t Fleet::Strength() const
 
 
 
+// Get the sprites of every ship that this fleet may contain.
+set<const Sprite *> Fleet::ShipSprites() const
+{
+	set<const Sprite *> sprites;
+	for(const Variant &variant : variants)
+		for(const Ship *ship : variant.ships)
+			if(ship->GetSprite())
+				sprites.insert(ship->GetSprite());
+	return sprites;
+}
+
+
+
 Fleet::Variant::Variant(const DataNode &node)
 {
 	weight = 1;
@@ -29,6 +29,7 @@ class Outfit;
 class Phrase;
 class Planet;
 class Ship;
+class Sprite;
 class System;
 
 
@@ -67,6 +68,8 @@ public:
 	static void Place(const System &system, Ship &ship);
 	
 	int64_t Strength() const;
+	// Get the sprites of every ship that this fleet may contain.
+	std::set<const Sprite *> ShipSprites() const;
 	
 	
 private:
@@ -20,6 +20,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "DataFile.h"
 #include "DataNode.h"
 #include "DataWriter.h"
+#include "DistanceMap.h"
 #include "Effect.h"
 #include "Files.h"
 #include "FillShader.h"
@@ -33,8 +34,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "ImageSet.h"
 #include "Interface.h"
 #include "LineShader.h"
+#include "MaskCache.h"
 #include "Minable.h"
 #include "Mission.h"
+#include "MissionIndex.h"
 #include "Music.h"
 #include "News.h"
 #include "Outfit.h"
@@ -42,8 +45,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Person.h"
 #include "Phrase.h"
 #include "Planet.h"
+#include "Point.h"
 #include "PointerShader.h"
 #include "Politics.h"
+#include "Preferences.h"
 #include "Random.h"
 #include "RingShader.h"
 #include "Ship.h"
@@ -53,12 +58,19 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "SpriteShader.h"
 #include "StarField.h"
 #include "StartConditions.h"
+#include "StellarObject.h"
 #include "System.h"
 #include "Test.h"
 #include "TestData.h"
+#include "TextureCache.h"
+#include "Timeline.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
 #include <iostream>
+#include <list>
 #include <map>
 #include <set>
 #include <utility>
@@ -80,6 +92,10 @@ namespace {
 	Set<Interface> interfaces;
 	Set<Minable> minables;
 	Set<Mission> missions;
+	// The missions sorted by where they are offered. This is rebuilt whenever
+	// a mission is reloaded or added to the set.
+	MissionIndex missionIndex;
+	int indexedMissions = -1;
 	Set<Outfit> outfits;
 	Set<Person> persons;
 	Set<Phrase> phrases;
@@ -106,6 +122,16 @@ namespace {
 	
 	Trade trade;
 	map<const System *, map<string, int>> purchases;
+	// The prices of each commodity in each system that has links, in the order
+	// of trade.Commodities(), and each system's links to the others, so that
+	// sending out the trade goods each day needs no lookups by name. Rebuild
+	// these whenever the systems change.
+	bool economyIsStale = true;
+	vector<System::Price *> economyPrices;
+	vector<size_t> economyLinkBegin;
+	vector<size_t> economyLinks;
+	vector<double> economyLinkScale;
+	vector<double> economyExports;
 	
 	map<const Sprite *, string> landingMessages;
 	map<const Sprite *, double> solarPower;
@@ -122,15 +148,38 @@ namespace {
 	map<string, string> plugins;
 	
 	SpriteQueue spriteQueue;
-	// Whether sprites and audio have finished loading at game startup.
+	// Whether sprites and audio have finished loading at game startup. The
+	// sprites that are only shown in panels may still be loading after that.
 	bool initiallyLoaded = false;
+	bool fullyLoaded = false;
 	
 	vector<string> sources;
 	map<const Sprite *, shared_ptr<ImageSet>> deferred;
 	map<const Sprite *, int> preloaded;
+	// All other sprites may be evicted if their textures use more memory than
+	// the player's budget, and loaded again the next time they are drawn. For
+	// each evicted sprite, remember the frame in which it was evicted.
+	map<const Sprite *, shared_ptr<ImageSet>> evictable;
+	map<const Sprite *, int> evicted;
+	int nextBudgetCheck = 0;
 	
 	const Government *playerGovernment = nullptr;
 	
+	// When only checking the data for errors, or in debug mode, every deferred
+	// object is loaded before checking references, so that the objects that
+	// only it refers to are checked too.
+	bool checkDeferred = false;
+	
+	// For hot reloading, remember the modification time of each data file and
+	// image, the order in which the data files are loaded, and which objects
+	// each data file defines. Each object is identified by its root node's
+	// key and its name.
+	bool hotReload = false;
+	chrono::steady_clock::time_point nextChangeCheck;
+	map<string, time_t> fileTimes;
+	vector<string> dataFiles;
+	map<string, set<pair<string, string>>> fileDefinitions;
+	
 	// TODO (C++14): make these 3 methods generic lambdas visible only to the CheckReferences method.
 	// Log a warning for an "undefined" class object that was never loaded from disk.
 	void Warn(const string &noun, const string &name)
@@ -155,6 +204,125 @@ namespace {
 		it.second.SetName(it.first);
 		Warn(noun, it.first);
 	}
+	
+	// Get the order in which the sprite with the given name should be loaded
+	// at startup. The interface is needed to show the main menu, and the ships,
+	// stellar objects, and weapon effects are needed as soon as the player is
+	// in flight. Everything else is only shown in panels.
+	SpriteQueue::Priority LoadPriority(const string &name)
+	{
+		static const vector<string> INTERFACE = {"ui/", "_menu/", "icon/", "label/", "font/"};
+		static const vector<string> BACKGROUND = {"outfit/", "thumbnail/", "scene/", "portrait/"};
+		for(const string &prefix : INTERFACE)
+			if(!name.compare(0, prefix.length(), prefix))
+				return SpriteQueue::Priority::INTERFACE;
+		for(const string &prefix : BACKGROUND)
+			if(!name.compare(0, prefix.length(), prefix))
+				return SpriteQueue::Priority::BACKGROUND;
+		return SpriteQueue::Priority::FLIGHT;
+	}
+	
+	// Load any evicted sprites that are being drawn again. Then, if the sprites'
+	// textures use more memory than the player's budget, evict the textures of
+	// the sprites that were drawn least recently.
+	void ManageTextureMemory(int frame)
+	{
+		for(auto it = evicted.begin(); it != evicted.end(); )
+		{
+			if(it->first->LastDrawn() > it->second)
+			{
+				spriteQueue.Add(evictable[it->first]);
+				it = evicted.erase(it);
+			}
+			else
+				++it;
+		}
+		
+		size_t budget = static_cast<size_t>(Preferences::TextureBudget()) << 20;
+		if(!budget || Sprite::TotalTextureMemory() <= budget || frame < nextBudgetCheck)
+			return;
+		// Sorting the sprites is not free, so only do this once a second.
+		nextBudgetCheck = frame + 60;
+		
+		// Never evict a sprite that was drawn within the last second.
+		vector<pair<int, const Sprite *>> candidates;
+		for(const auto &it : evictable)
+			if(it.first->TextureMemory() && it.first->LastDrawn() < frame - 60)
+				candidates.emplace_back(it.first->LastDrawn(), it.first);
+		sort(candidates.begin(), candidates.end());
+		
+		// Free up somewhat more memory than is needed, so that this does not
+		// have to be done again as soon as another sprite is loaded.
+		size_t target = budget - budget / 8;
+		size_t total = Sprite::TotalTextureMemory();
+		for(const auto &it : candidates)
+		{
+			if(total <= target)
+				break;
+			total -= it.second->TextureMemory();
+			spriteQueue.Evict(it.second->Name());
+			evicted[it.second] = frame;
+		}
+	}
+	
+	// Get the key and name of the object that the given root node defines.
+	pair<string, string> Definition(const DataNode &node)
+	{
+		// Ship variants are identified by the variant name.
+		if(node.Token(0) == "ship" && node.Size() >= 3)
+			return make_pair(node.Token(0), node.Token(2));
+		return make_pair(node.Token(0), node.Size() >= 2 ? node.Token(1) : string());
+	}
+	
+	// Check if the given file has been modified since it was last checked.
+	bool HasChanged(const string &path)
+	{
+		time_t timestamp = Files::Timestamp(path);
+		time_t &previous = fileTimes[path];
+		if(previous == timestamp)
+			return false;
+		
+		previous = timestamp;
+		return true;
+	}
+	
+	// Discard an object's definition so that it can be loaded again from its
+	// data files. Objects that events may change are not discarded, because
+	// their definitions can be applied on top of each other, just as events
+	// do. (Governments in particular must keep their IDs.)
+	void Discard(const pair<string, string> &definition)
+	{
+		const string &key = definition.first;
+		const string &name = definition.second;
+		if(key == "color")
+			colors.Discard(name);
+		else if(key == "conversation")
+			conversations.Discard(name);
+		else if(key == "effect")
+			effects.Discard(name);
+		else if(key == "event")
+			events.Discard(name);
+		else if(key == "hazard")
+			hazards.Discard(name);
+		else if(key == "interface")
+			interfaces.Discard(name);
+		else if(key == "minable")
+			minables.Discard(name);
+		else if(key == "mission")
+			missions.Discard(name);
+		else if(key == "outfit")
+			outfits.Discard(name);
+		else if(key == "person")
+			persons.Discard(name);
+		else if(key == "phrase")
+			phrases.Discard(name);
+		else if(key == "ship")
+			ships.Discard(name);
+		else if(key == "test")
+			tests.Discard(name);
+		else if(key == "test-data")
+			testDataSets.Discard(name);
+	}
 }
 
 
@@ -165,6 +333,7 @@ bool GameData::BeginLoad(const char * const *argv)
 	bool printTests = false;
 	bool printWeapons = false;
 	bool debugMode = false;
+	bool textureCache = false;
 	for(const char * const *it = argv + 1; *it; ++it)
 	{
 		if((*it)[0] == '-')
@@ -178,18 +347,40 @@ bool GameData::BeginLoad(const char * const *argv)
 				printTests = true;
 			if(arg == "-d" || arg == "--debug")
 				debugMode = true;
+			if(arg == "-d" || arg == "--debug" || arg == "-p" || arg == "--parse-save")
+				checkDeferred = true;
+			if(arg == "--hot-reload")
+				hotReload = true;
+			if(arg == "--texture-cache")
+				textureCache = true;
 			continue;
 		}
 	}
-	Files::Init(argv);
+	{
+		Timeline::Scope scope("Files::Init");
+		Files::Init(argv);
+	}
 	
 	// Initialize the list of "source" folders based on any active plugins.
-	LoadSources();
+	{
+		Timeline::Scope scope("LoadSources");
+		LoadSources();
+	}
 	
 	// Now, read all the images in all the path directories. For each unique
 	// name, only remember one instance, letting things on the higher priority
 	// paths override the default images.
-	map<string, shared_ptr<ImageSet>> images = FindImages();
+	map<string, shared_ptr<ImageSet>> images;
+	{
+		Timeline::Scope scope("FindImages");
+		images = FindImages();
+	}
+	
+	// Collision masks that were generated the last time the game was run do not
+	// need to be generated again.
+	MaskCache::Load();
+	if(textureCache)
+		TextureCache::Load();
 	
 	// From the name, strip out any frame number, plus the extension.
 	for(const auto &it : images)
@@ -204,33 +395,47 @@ bool GameData::BeginLoad(const char * const *argv)
 		if(ImageSet::IsDeferred(it.first))
 			deferred[SpriteSet::Get(it.first)] = it.second;
 		else
-			spriteQueue.Add(it.second);
+		{
+			evictable[SpriteSet::Get(it.first)] = it.second;
+			spriteQueue.Add(it.second, LoadPriority(it.first));
+		}
 	}
 	
 	// Generate a catalog of music files.
-	Music::Init(sources);
+	{
+		Timeline::Scope scope("Music::Init");
+		Music::Init(sources);
+	}
 	
-	for(const string &source : sources)
 	{
-		// Iterate through the paths starting with the last directory given. That
-		// is, things in folders near the start of the path have the ability to
-		// override things in folders later in the path.
-		vector<string> dataFiles = Files::RecursiveList(source + "data/");
-		for(const string &path : dataFiles)
-			LoadFile(path, debugMode);
+		Timeline::Scope scope("Load data files");
+		for(const string &source : sources)
+		{
+			// Iterate through the paths starting with the last directory given. That
+			// is, things in folders near the start of the path have the ability to
+			// override things in folders later in the path.
+			for(const string &path : Files::RecursiveList(source + "data/"))
+				LoadFile(path, debugMode);
+		}
 	}
 	
 	// Now that all data is loaded, update the neighbor lists and other
 	// system information. Make sure that the default jump range is among the
 	// neighbor distances to be updated.
 	AddJumpRange(System::DEFAULT_NEIGHBOR_DISTANCE);
-	UpdateSystems();
+	{
+		Timeline::Scope scope("UpdateSystems");
+		UpdateSystems();
+	}
 	
 	// And, update the ships with the outfits we've now finished loading.
-	for(auto &&it : ships)
-		it.second.FinishLoading(true);
-	for(auto &&it : persons)
-		it.second.FinishLoading();
+	{
+		Timeline::Scope scope("Ship::FinishLoading");
+		for(auto &&it : ships)
+			it.second.FinishLoading(true);
+		for(auto &&it : persons)
+			it.second.FinishLoading();
+	}
 	
 	for(auto &&it : startConditions)
 		it.FinishLoading();
@@ -268,9 +473,27 @@ bool GameData::BeginLoad(const char * const *argv)
 // planets) are written to the player's save and need a name to prevent data loss.
 void GameData::CheckReferences()
 {
+	// Missions, conversations, events and phrases that have not been requested
+	// yet each have at least one definition. Normally they are not loaded here,
+	// but then anything that only they refer to is not checked.
+	if(checkDeferred)
+	{
+		missions.LoadAll();
+		conversations.LoadAll();
+		events.LoadAll();
+		phrases.LoadAll();
+	}
+	
 	// Parse all GameEvents for object definitions.
 	auto deferred = map<string, set<string>>{};
-	for(auto &&it : events)
+	for(auto &&it : events.Deferred())
+		for(const DataNode &node : it.second)
+		{
+			auto definitions = GameEvent::DeferredDefinitions(list<DataNode>(node.begin(), node.end()));
+			for(auto &&type : definitions)
+				deferred[type.first].insert(type.second.begin(), type.second.end());
+		}
+	for(auto &&it : events.Loaded())
 	{
 		// Stock GameEvents are serialized in MissionActions by name.
 		if(it.second.Name().empty())
@@ -285,7 +508,7 @@ void GameData::CheckReferences()
 	}
 	
 	// Stock conversations are never serialized.
-	for(const auto &it : conversations)
+	for(const auto &it : conversations.Loaded())
 		if(it.second.IsEmpty())
 			Warn("conversation", it.first);
 	// The "default intro" conversation must invoke the prompt to set the player's name.
@@ -314,7 +537,7 @@ void GameData::CheckReferences()
 			Warn("minable", it.first);
 	// Stock missions are never serialized, and an accepted mission is
 	// always fully defined (though possibly not "valid").
-	for(const auto &it : missions)
+	for(const auto &it : missions.Loaded())
 		if(it.second.Name().empty())
 			Warn("mission", it.first);
 	
@@ -329,7 +552,7 @@ void GameData::CheckReferences()
 		if(it.second.empty() && !deferred["outfitter"].count(it.first))
 			Files::LogError("Warning: outfitter \"" + it.first + "\" is referred to, but has no outfits.");
 	// Phrases are never serialized.
-	for(const auto &it : phrases)
+	for(const auto &it : phrases.Loaded())
 		if(it.second.Name().empty())
 			Warn("phrase", it.first);
 	// Planet names are used by a number of classes.
@@ -380,20 +603,31 @@ void GameData::LoadShaders(bool useShaderSwizzle)
 
 double GameData::Progress()
 {
+	int frame = Sprite::NextFrame();
 	auto progress = min(spriteQueue.Progress(), Audio::GetProgress());
-	if(progress == 1.)
+	if(progress == 1. && !initiallyLoaded)
 	{
-		if(!initiallyLoaded)
-		{
-			// Now that we have finished loading all the basic sprites, we can look for invalid file paths,
-			// e.g. due to capitalization errors or other typos. Landscapes are allowed to still be empty.
-			auto unloaded = SpriteSet::CheckReferences();
-			for(const auto &path : unloaded)
-				if(path.compare(0, 5, "land/") != 0)
-					Files::LogError("Warning: image \"" + path + "\" is referred to, but has no pixels.");
-			initiallyLoaded = true;
-		}
+		initiallyLoaded = true;
+		Timeline::Write("Time to menu");
 	}
+	if(initiallyLoaded && !fullyLoaded && spriteQueue.IsFinished())
+	{
+		// Now that we have finished loading all the basic sprites, we can look for invalid file paths,
+		// e.g. due to capitalization errors or other typos. Landscapes are allowed to still be empty.
+		auto unloaded = SpriteSet::CheckReferences();
+		for(const auto &path : unloaded)
+			if(path.compare(0, 5, "land/") != 0)
+				Files::LogError("Warning: image \"" + path + "\" is referred to, but has no pixels.");
+		fullyLoaded = true;
+		MaskCache::Save();
+		Timeline::Write("Time to load all sprites");
+		Timeline::Stop();
+	}
+	// Any sprite that was drawn before it was loaded should be loaded next.
+	for(const Sprite *sprite : Sprite::DrawnBeforeLoading())
+		spriteQueue.Prioritize(sprite->Name());
+	if(fullyLoaded)
+		ManageTextureMemory(frame);
 	return progress;
 }
 
@@ -453,6 +687,42 @@ void GameData::Preload(const Sprite *sprite)
 
 
 
+// Begin loading everything that will be needed when the player enters the
+// given system: its landscapes, and the sprites of its stellar objects,
+// asteroids, haze, and the ships of the fleets that appear there. Any of
+// those sprites that are not loaded yet or were evicted are treated as if
+// they were being drawn, which moves them to the front of the loading queue.
+void GameData::Prefetch(const System *system)
+{
+	if(!system)
+		return;
+	
+	set<const Sprite *> sprites;
+	for(const StellarObject &object : system->Objects())
+	{
+		if(object.HasSprite())
+			sprites.insert(object.GetSprite());
+		if(object.HasValidPlanet())
+			Preload(object.GetPlanet()->Landscape());
+	}
+	for(const System::Asteroid &asteroid : system->Asteroids())
+		sprites.insert(asteroid.Type() ? asteroid.Type()->GetSprite()
+			: SpriteSet::Get("asteroid/" + asteroid.Name() + "/spin"));
+	sprites.insert(system->Haze());
+	for(const System::FleetProbability &fleet : system->Fleets())
+	{
+		set<const Sprite *> shipSprites = fleet.Get()->ShipSprites();
+		sprites.insert(shipSprites.begin(), shipSprites.end());
+	}
+	
+	for(const Sprite *sprite : sprites)
+		if(sprite)
+			sprite->MarkUsed();
+}
+
+
+
+// Wait until every sprite but the ones only shown in panels is loaded.
 void GameData::FinishLoading()
 {
 	spriteQueue.Finish();
@@ -460,6 +730,49 @@ void GameData::FinishLoading()
 
 
 
+// Stop the threads that load sprites.
+void GameData::Quit()
+{
+	spriteQueue.Stop();
+}
+
+
+
+// If hot reloading is enabled, reload any data files and images that have
+// changed since they were loaded.
+void GameData::CheckForChanges()
+{
+	if(!hotReload || chrono::steady_clock::now() < nextChangeCheck)
+		return;
+	// Checking every file's timestamp is not free, so only do it once a second.
+	nextChangeCheck = chrono::steady_clock::now() + chrono::seconds(1);
+	
+	vector<string> changedFiles;
+	set<string> changedImages;
+	dataFiles.clear();
+	for(const string &source : sources)
+	{
+		for(const string &path : Files::RecursiveList(source + "data/"))
+		{
+			dataFiles.push_back(path);
+			if(HasChanged(path))
+				changedFiles.push_back(path);
+		}
+		
+		string directoryPath = source + "images/";
+		for(const string &path : Files::RecursiveList(directoryPath))
+			if(ImageSet::IsImage(path) && HasChanged(path))
+				changedImages.insert(ImageSet::Name(path.substr(directoryPath.size())));
+	}
+	
+	if(!changedFiles.empty())
+		ReloadData(changedFiles);
+	if(!changedImages.empty())
+		ReloadImages(changedImages);
+}
+
+
+
 // Get the list of resource sources (i.e. plugin folders).
 const vector<string> &GameData::Sources()
 {
@@ -483,6 +796,9 @@ void GameData::Revert()
 	
 	politics.Reset();
 	purchases.clear();
+	// Reverting the systems may have restored links that events removed.
+	DistanceMap::ClearCache();
+	economyIsStale = true;
 }
 
 
@@ -593,21 +909,28 @@ void GameData::StepEconomy()
 	// Finally, send out the trade goods. This has to be done in a separate step
 	// because otherwise whichever systems trade last would already have gotten
 	// supplied by the other systems.
-	for(auto &it : systems)
+	if(economyIsStale)
+		IndexEconomy();
+	// Copy all the exports into one array first, so that each system's exports
+	// are next to each other in memory when its neighbors look them up.
+	for(size_t i = 0; i < economyPrices.size(); ++i)
+		economyExports[i] = (economyPrices[i] ? economyPrices[i]->exports : 0.);
+	
+	const size_t commodities = trade.Commodities().size();
+	for(size_t i = 0; i + 1 < economyLinkBegin.size(); ++i)
 	{
-		System &system = it.second;
-		if(!system.Links().empty())
-			for(const Trade::Commodity &commodity : trade.Commodities())
-			{
-				double supply = system.Supply(commodity.name);
-				for(const System *neighbor : system.Links())
-				{
-					double scale = neighbor->Links().size();
-					if(scale)
-						supply += neighbor->Exports(commodity.name) / scale;
-				}
-				system.SetSupply(commodity.name, supply);
-			}
+		System::Price **prices = &economyPrices[i * commodities];
+		for(size_t c = 0; c < commodities; ++c)
+		{
+			if(!prices[c])
+				continue;
+			
+			double supply = prices[c]->supply;
+			for(size_t link = economyLinkBegin[i]; link < economyLinkBegin[i + 1]; ++link)
+				supply += economyExports[economyLinks[link] * commodities + c] / economyLinkScale[link];
+			prices[c]->supply = supply;
+			prices[c]->Update();
+		}
 	}
 }
 
@@ -621,6 +944,47 @@ void GameData::AddPurchase(const System &system, const string &commodity, int to
 
 
 
+// Find where each system's commodity prices are, and which systems each one
+// receives trade goods from, for StepEconomy().
+void GameData::IndexEconomy()
+{
+	economyPrices.clear();
+	economyLinkBegin.clear();
+	economyLinks.clear();
+	economyLinkScale.clear();
+	
+	// Number the systems that have links. Only those trade with each other.
+	map<const System *, size_t> index;
+	vector<System *> linked;
+	for(auto &it : systems)
+		if(!it.second.Links().empty())
+		{
+			index[&it.second] = linked.size();
+			linked.push_back(&it.second);
+		}
+	
+	for(System *system : linked)
+	{
+		for(const Trade::Commodity &commodity : trade.Commodities())
+			economyPrices.push_back(system->GetPrice(commodity.name));
+		
+		economyLinkBegin.push_back(economyLinks.size());
+		for(const System *neighbor : system->Links())
+		{
+			auto it = index.find(neighbor);
+			if(it == index.end())
+				continue;
+			economyLinks.push_back(it->second);
+			economyLinkScale.push_back(neighbor->Links().size());
+		}
+	}
+	economyLinkBegin.push_back(economyLinks.size());
+	economyExports.resize(economyPrices.size());
+	economyIsStale = false;
+}
+
+
+
 // Apply the given change to the universe.
 void GameData::Change(const DataNode &node)
 {
@@ -654,12 +1018,43 @@ void GameData::Change(const DataNode &node)
 // This must be done any time that a change creates or moves a system.
 void GameData::UpdateSystems()
 {
+	DistanceMap::ClearCache();
+	economyIsStale = true;
+	
+	// Sort the named systems into a grid of squares as wide as the longest
+	// jump range, so that finding a system's neighbors only requires checking
+	// the systems in the squares around it rather than every other system.
+	double cellSize = max(System::DEFAULT_NEIGHBOR_DISTANCE,
+		neighborDistances.empty() ? 0. : *neighborDistances.rbegin());
+	auto cell = [cellSize](const Point &point) -> pair<int, int>
+	{
+		return make_pair(static_cast<int>(floor(point.X() / cellSize)), static_cast<int>(floor(point.Y() / cellSize)));
+	};
+	map<pair<int, int>, vector<const System *>> grid;
+	for(const auto &it : systems)
+		if(!it.first.empty() && !it.second.Name().empty())
+			grid[cell(it.second.Position())].push_back(&it.second);
+	
+	vector<const System *> nearby;
 	for(auto &it : systems)
 	{
 		// Skip systems that have no name.
 		if(it.first.empty() || it.second.Name().empty())
 			continue;
-		it.second.UpdateSystem(systems, neighborDistances);
+		
+		// A system with its own jump range may reach farther than one square.
+		double range = it.second.JumpRange() ? max(it.second.JumpRange(), System::DEFAULT_NEIGHBOR_DISTANCE) : cellSize;
+		int reach = max(1, static_cast<int>(ceil(range / cellSize)));
+		pair<int, int> center = cell(it.second.Position());
+		nearby.clear();
+		for(int y = center.second - reach; y <= center.second + reach; ++y)
+			for(int x = center.first - reach; x <= center.first + reach; ++x)
+			{
+				auto sit = grid.find(make_pair(x, y));
+				if(sit != grid.end())
+					nearby.insert(nearby.end(), sit->second.begin(), sit->second.end());
+			}
+		it.second.UpdateSystem(nearby, neighborDistances);
 	}
 }
 
@@ -770,6 +1165,18 @@ const Set<Mission> &GameData::Missions()
 
 
 
+const MissionIndex &GameData::MissionOffers()
+{
+	if(indexedMissions != missions.size())
+	{
+		missionIndex.Build(missions);
+		indexedMissions = missions.size();
+	}
+	return missionIndex;
+}
+
+
+
 const Set<News> &GameData::SpaceportNews()
 {
 	return news;
@@ -1046,149 +1453,164 @@ void GameData::LoadFile(const string &path, bool debugMode)
 	if(path.length() < 4 || path.compare(path.length() - 4, 4, ".txt"))
 		return;
 	
+	Timeline::Scope scope("Parse data file", path);
 	DataFile data(path);
 	if(debugMode)
 		Files::LogError("Parsing: " + path);
 	
 	for(const DataNode &node : data)
+		LoadNode(node, path);
+	
+	if(hotReload)
 	{
-		const string &key = node.Token(0);
-		if(key == "color" && node.Size() >= 6)
-			colors.Get(node.Token(1))->Load(
-				node.Value(2), node.Value(3), node.Value(4), node.Value(5));
-		else if(key == "conversation" && node.Size() >= 2)
-			conversations.Get(node.Token(1))->Load(node);
-		else if(key == "effect" && node.Size() >= 2)
-			effects.Get(node.Token(1))->Load(node);
-		else if(key == "event" && node.Size() >= 2)
-			events.Get(node.Token(1))->Load(node);
-		else if(key == "fleet" && node.Size() >= 2)
-			fleets.Get(node.Token(1))->Load(node);
-		else if(key == "galaxy" && node.Size() >= 2)
-			galaxies.Get(node.Token(1))->Load(node);
-		else if(key == "government" && node.Size() >= 2)
-			governments.Get(node.Token(1))->Load(node);
-		else if(key == "hazard" && node.Size() >= 2)
-			hazards.Get(node.Token(1))->Load(node);
-		else if(key == "interface" && node.Size() >= 2)
-			interfaces.Get(node.Token(1))->Load(node);
-		else if(key == "minable" && node.Size() >= 2)
-			minables.Get(node.Token(1))->Load(node);
-		else if(key == "mission" && node.Size() >= 2)
-			missions.Get(node.Token(1))->Load(node);
-		else if(key == "outfit" && node.Size() >= 2)
-			outfits.Get(node.Token(1))->Load(node);
-		else if(key == "outfitter" && node.Size() >= 2)
-			outfitSales.Get(node.Token(1))->Load(node, outfits);
-		else if(key == "person" && node.Size() >= 2)
-			persons.Get(node.Token(1))->Load(node);
-		else if(key == "phrase" && node.Size() >= 2)
-			phrases.Get(node.Token(1))->Load(node);
-		else if(key == "planet" && node.Size() >= 2)
-			planets.Get(node.Token(1))->Load(node);
-		else if(key == "ship" && node.Size() >= 2)
-		{
-			// Allow multiple named variants of the same ship model.
-			const string &name = node.Token((node.Size() > 2) ? 2 : 1);
-			ships.Get(name)->Load(node);
-		}
-		else if(key == "shipyard" && node.Size() >= 2)
-			shipSales.Get(node.Token(1))->Load(node, ships);
-		else if(key == "start" && node.HasChildren())
+		dataFiles.push_back(path);
+		fileTimes[path] = Files::Timestamp(path);
+		set<pair<string, string>> &definitions = fileDefinitions[path];
+		for(const DataNode &node : data)
+			definitions.insert(Definition(node));
+	}
+}
+
+
+
+void GameData::LoadNode(const DataNode &node, const string &path)
+{
+	const string &key = node.Token(0);
+	if(key == "color" && node.Size() >= 6)
+		colors.Get(node.Token(1))->Load(
+			node.Value(2), node.Value(3), node.Value(4), node.Value(5));
+	else if(key == "conversation" && node.Size() >= 2)
+		conversations.Defer(node.Token(1), node);
+	else if(key == "effect" && node.Size() >= 2)
+		effects.Get(node.Token(1))->Load(node);
+	else if(key == "event" && node.Size() >= 2)
+		events.Defer(node.Token(1), node);
+	else if(key == "fleet" && node.Size() >= 2)
+		fleets.Get(node.Token(1))->Load(node);
+	else if(key == "galaxy" && node.Size() >= 2)
+		galaxies.Get(node.Token(1))->Load(node);
+	else if(key == "government" && node.Size() >= 2)
+		governments.Get(node.Token(1))->Load(node);
+	else if(key == "hazard" && node.Size() >= 2)
+		hazards.Get(node.Token(1))->Load(node);
+	else if(key == "interface" && node.Size() >= 2)
+		interfaces.Get(node.Token(1))->Load(node);
+	else if(key == "minable" && node.Size() >= 2)
+		minables.Get(node.Token(1))->Load(node);
+	else if(key == "mission" && node.Size() >= 2)
+		missions.Defer(node.Token(1), node);
+	else if(key == "outfit" && node.Size() >= 2)
+		outfits.Get(node.Token(1))->Load(node);
+	else if(key == "outfitter" && node.Size() >= 2)
+		outfitSales.Get(node.Token(1))->Load(node, outfits);
+	else if(key == "person" && node.Size() >= 2)
+		persons.Get(node.Token(1))->Load(node);
+	else if(key == "phrase" && node.Size() >= 2)
+		phrases.Defer(node.Token(1), node);
+	else if(key == "planet" && node.Size() >= 2)
+		planets.Get(node.Token(1))->Load(node);
+	else if(key == "ship" && node.Size() >= 2)
+	{
+		// Allow multiple named variants of the same ship model.
+		const string &name = node.Token((node.Size() > 2) ? 2 : 1);
+		ships.Get(name)->Load(node);
+	}
+	else if(key == "shipyard" && node.Size() >= 2)
+		shipSales.Get(node.Token(1))->Load(node, ships);
+	else if(key == "start" && node.HasChildren())
+	{
+		// This node may either declare an immutable starting scenario, or one that is open to extension
+		// by other nodes (e.g. plugins may customize the basic start, rather than provide a unique start).
+		if(node.Size() == 1)
+			startConditions.emplace_back(node);
+		else
 		{
-			// This node may either declare an immutable starting scenario, or one that is open to extension
-			// by other nodes (e.g. plugins may customize the basic start, rather than provide a unique start).
-			if(node.Size() == 1)
-				startConditions.emplace_back(node);
+			const string &identifier = node.Token(1);
+			auto existingStart = find_if(startConditions.begin(), startConditions.end(),
+				[&identifier](const StartConditions &it) noexcept -> bool { return it.Identifier() == identifier; });
+			if(existingStart != startConditions.end())
+				existingStart->Load(node);
 			else
-			{
-				const string &identifier = node.Token(1);
-				auto existingStart = find_if(startConditions.begin(), startConditions.end(),
-					[&identifier](const StartConditions &it) noexcept -> bool { return it.Identifier() == identifier; });
-				if(existingStart != startConditions.end())
-					existingStart->Load(node);
-				else
-					startConditions.emplace_back(node);
-			}
-		}
-		else if(key == "system" && node.Size() >= 2)
-			systems.Get(node.Token(1))->Load(node, planets);
-		else if((key == "test") && node.Size() >= 2)
-			tests.Get(node.Token(1))->Load(node);
-		else if((key == "test-data") && node.Size() >= 2)
-			testDataSets.Get(node.Token(1))->Load(node, path);
-		else if(key == "trade")
-			trade.Load(node);
-		else if(key == "landing message" && node.Size() >= 2)
-		{
-			for(const DataNode &child : node)
-				landingMessages[SpriteSet::Get(child.Token(0))] = node.Token(1);
+				startConditions.emplace_back(node);
 		}
-		else if(key == "star" && node.Size() >= 2)
+	}
+	else if(key == "system" && node.Size() >= 2)
+		systems.Get(node.Token(1))->Load(node, planets);
+	else if((key == "test") && node.Size() >= 2)
+		tests.Get(node.Token(1))->Load(node);
+	else if((key == "test-data") && node.Size() >= 2)
+		testDataSets.Get(node.Token(1))->Load(node, path);
+	else if(key == "trade")
+		trade.Load(node);
+	else if(key == "landing message" && node.Size() >= 2)
+	{
+		for(const DataNode &child : node)
+			landingMessages[SpriteSet::Get(child.Token(0))] = node.Token(1);
+	}
+	else if(key == "star" && node.Size() >= 2)
+	{
+		const Sprite *sprite = SpriteSet::Get(node.Token(1));
+		for(const DataNode &child : node)
 		{
-			const Sprite *sprite = SpriteSet::Get(node.Token(1));
-			for(const DataNode &child : node)
-			{
-				if(child.Token(0) == "power" && child.Size() >= 2)
-					solarPower[sprite] = child.Value(1);
-				else if(child.Token(0) == "wind" && child.Size() >= 2)
-					solarWind[sprite] = child.Value(1);
-				else
-					child.PrintTrace("Unrecognized star attribute:");
-			}
+			if(child.Token(0) == "power" && child.Size() >= 2)
+				solarPower[sprite] = child.Value(1);
+			else if(child.Token(0) == "wind" && child.Size() >= 2)
+				solarWind[sprite] = child.Value(1);
+			else
+				child.PrintTrace("Unrecognized star attribute:");
 		}
-		else if(key == "news" && node.Size() >= 2)
-			news.Get(node.Token(1))->Load(node);
-		else if(key == "rating" && node.Size() >= 2)
+	}
+	else if(key == "news" && node.Size() >= 2)
+		news.Get(node.Token(1))->Load(node);
+	else if(key == "rating" && node.Size() >= 2)
+	{
+		vector<string> &list = ratings[node.Token(1)];
+		list.clear();
+		for(const DataNode &child : node)
+			list.push_back(child.Token(0));
+	}
+	else if(key == "category" && node.Size() >= 2)
+	{
+		static const map<string, CategoryType> category = {
+			{"ship", CategoryType::SHIP},
+			{"bay type", CategoryType::BAY},
+			{"outfit", CategoryType::OUTFIT}
+		};
+		auto it = category.find(node.Token(1));
+		if(it == category.end())
 		{
-			vector<string> &list = ratings[node.Token(1)];
-			list.clear();
-			for(const DataNode &child : node)
-				list.push_back(child.Token(0));
+			node.PrintTrace("Skipping unrecognized category:");
+			return;
 		}
-		else if(key == "category" && node.Size() >= 2)
+		
+		vector<string> &categoryList = categories[it->second];
+		for(const DataNode &child : node)
 		{
-			static const map<string, CategoryType> category = {
-				{"ship", CategoryType::SHIP},
-				{"bay type", CategoryType::BAY},
-				{"outfit", CategoryType::OUTFIT}
-			};
-			auto it = category.find(node.Token(1));
-			if(it == category.end())
-			{
-				node.PrintTrace("Skipping unrecognized category:");
-				continue;
-			}
-			
-			vector<string> &categoryList = categories[it->second];
-			for(const DataNode &child : node)
-			{
-				// If a given category already exists, it will be
-				// moved to the back of the list.
-				const auto it = find(categoryList.begin(), categoryList.end(), child.Token(0));
-				if(it != categoryList.end())
-					categoryList.erase(it);
-				categoryList.push_back(child.Token(0));
-			}
+			// If a given category already exists, it will be
+			// moved to the back of the list.
+			const auto it = find(categoryList.begin(), categoryList.end(), child.Token(0));
+			if(it != categoryList.end())
+				categoryList.erase(it);
+			categoryList.push_back(child.Token(0));
 		}
-		else if((key == "tip" || key == "help") && node.Size() >= 2)
+	}
+	else if((key == "tip" || key == "help") && node.Size() >= 2)
+	{
+		string &text = (key == "tip" ? tooltips : helpMessages)[node.Token(1)];
+		text.clear();
+		for(const DataNode &child : node)
 		{
-			string &text = (key == "tip" ? tooltips : helpMessages)[node.Token(1)];
-			text.clear();
-			for(const DataNode &child : node)
+			if(!text.empty())
 			{
-				if(!text.empty())
-				{
-					text += '\n';
-					if(child.Token(0)[0] != '\t')
-						text += '\t';
-				}
-				text += child.Token(0);
+				text += '\n';
+				if(child.Token(0)[0] != '\t')
+					text += '\t';
 			}
+			text += child.Token(0);
 		}
-		else
-			node.PrintTrace("Skipping unrecognized root object:");
 	}
+	else
+		node.PrintTrace("Skipping unrecognized root object:");
 }
 
 
@@ -1213,6 +1635,8 @@ map<string, shared_ptr<ImageSet>> GameData::FindImages()
 				if(!imageSet)
 					imageSet.reset(new ImageSet(name));
 				imageSet->Add(path);
+				if(hotReload)
+					fileTimes[path] = Files::Timestamp(path);
 			}
 	}
 	return images;
@@ -1220,6 +1644,150 @@ map<string, shared_ptr<ImageSet>> GameData::FindImages()
 
 
 
+// Reload every object that is defined in any of the given data files, from all
+// the files that define it, and then update whatever depends on those objects.
+void GameData::ReloadData(const vector<string> &changedFiles)
+{
+	set<pair<string, string>> reloaded;
+	map<string, shared_ptr<DataFile>> parsed;
+	for(const string &path : changedFiles)
+	{
+		Files::LogError("Reloading: " + path);
+		// Objects that this file used to define must also be reloaded, in case
+		// their definitions were removed from it.
+		set<pair<string, string>> &definitions = fileDefinitions[path];
+		reloaded.insert(definitions.begin(), definitions.end());
+		definitions.clear();
+		
+		shared_ptr<DataFile> &data = parsed[path];
+		data.reset(new DataFile(path));
+		for(const DataNode &node : *data)
+			definitions.insert(Definition(node));
+		reloaded.insert(definitions.begin(), definitions.end());
+	}
+	
+	// A ship's attributes include those of its outfits and of the model it is
+	// a variant of, so if any outfit or ship changed, reload all the ships.
+	if(any_of(reloaded.begin(), reloaded.end(), [](const pair<string, string> &it) -> bool
+			{ return it.first == "outfit" || it.first == "ship"; }))
+		for(const auto &it : fileDefinitions)
+			for(const auto &definition : it.second)
+				if(definition.first == "ship")
+					reloaded.insert(definition);
+	
+	// Starting conditions and the trade commodities are added to lists rather
+	// than replacing anything, so they cannot be reloaded.
+	for(auto it = reloaded.begin(); it != reloaded.end(); )
+	{
+		if(it->first == "start" || it->first == "trade")
+		{
+			Files::LogError("Warning: \"" + it->first + "\" definitions cannot be reloaded without restarting.");
+			it = reloaded.erase(it);
+		}
+		else
+			Discard(*it++);
+	}
+	
+	// Apply the definitions in the same order that they were originally loaded,
+	// so that plugins still override the base game.
+	for(const string &path : dataFiles)
+	{
+		const set<pair<string, string>> &definitions = fileDefinitions[path];
+		if(none_of(definitions.begin(), definitions.end(), [&reloaded](const pair<string, string> &it) -> bool
+				{ return reloaded.count(it); }))
+			continue;
+		
+		shared_ptr<DataFile> &data = parsed[path];
+		if(!data)
+			data.reset(new DataFile(path));
+		for(const DataNode &node : *data)
+			if(reloaded.count(Definition(node)))
+				LoadNode(node, path);
+	}
+	
+	// Update the derived information for whatever was reloaded.
+	bool updateSystems = false;
+	for(const auto &it : reloaded)
+	{
+		const string &key = it.first;
+		const string &name = it.second;
+		updateSystems |= (key == "system" || key == "planet" || key == "galaxy");
+		if(key == "mission")
+			indexedMissions = -1;
+		if(key == "ship")
+			ships.Get(name)->FinishLoading(true);
+		else if(key == "person")
+			persons.Get(name)->FinishLoading();
+		// The state to revert to when loading a different pilot must include
+		// the reloaded definitions.
+		else if(key == "fleet")
+			*defaultFleets.Get(name) = *fleets.Get(name);
+		else if(key == "government")
+			*defaultGovernments.Get(name) = *governments.Get(name);
+		else if(key == "planet")
+			*defaultPlanets.Get(name) = *planets.Get(name);
+		else if(key == "system")
+			*defaultSystems.Get(name) = *systems.Get(name);
+		else if(key == "galaxy")
+			*defaultGalaxies.Get(name) = *galaxies.Get(name);
+		else if(key == "shipyard")
+			*defaultShipSales.Get(name) = *shipSales.Get(name);
+		else if(key == "outfitter")
+			*defaultOutfitSales.Get(name) = *outfitSales.Get(name);
+	}
+	if(updateSystems)
+		UpdateSystems();
+}
+
+
+
+// Decode and upload the given sprites again, from all their image files.
+void GameData::ReloadImages(const set<string> &names)
+{
+	map<string, shared_ptr<ImageSet>> images;
+	for(const string &source : sources)
+	{
+		string directoryPath = source + "images/";
+		for(const string &path : Files::RecursiveList(directoryPath))
+			if(ImageSet::IsImage(path))
+			{
+				string name = ImageSet::Name(path.substr(directoryPath.size()));
+				if(!names.count(name))
+					continue;
+				
+				shared_ptr<ImageSet> &imageSet = images[name];
+				if(!imageSet)
+					imageSet.reset(new ImageSet(name));
+				imageSet->Add(path);
+			}
+	}
+	
+	for(const auto &it : images)
+	{
+		Files::LogError("Reloading image: " + it.first);
+		it.second->Check();
+		// Landscapes that are not currently loaded only need to remember their
+		// new files for the next time they are needed.
+		if(ImageSet::IsDeferred(it.first))
+		{
+			const Sprite *sprite = SpriteSet::Get(it.first);
+			deferred[sprite] = it.second;
+			if(!preloaded.count(sprite))
+				continue;
+		}
+		else
+		{
+			const Sprite *sprite = SpriteSet::Get(it.first);
+			evictable[sprite] = it.second;
+			evicted.erase(sprite);
+		}
+		spriteQueue.Unload(it.first);
+		spriteQueue.Add(it.second);
+	}
+}
+
+
+
 // This prints out the list of tests that are available and their status
 // (active/missing feature/known failure)..
 void GameData::PrintTestsTable()
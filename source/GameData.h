@@ -20,6 +20,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -38,6 +39,7 @@ class ImageSet;
 class Interface;
 class Minable;
 class Mission;
+class MissionIndex;
 class News;
 class Outfit;
 class Person;
@@ -73,7 +75,18 @@ public:
 	// Begin loading a sprite that was previously deferred. Currently this is
 	// done with all landscapes to speed up the program's startup.
 	static void Preload(const Sprite *sprite);
+	// Begin loading everything that will be needed when the player enters the
+	// given system, if any of it is not already loaded.
+	static void Prefetch(const System *system);
+	// Wait until every sprite but the ones only shown in panels is loaded.
 	static void FinishLoading();
+	// Stop the threads that load sprites. This must be done before the program
+	// exits, because those threads use other objects with static lifetimes.
+	static void Quit();
+	// If the game was started with "--hot-reload", reload any data files and
+	// images that have changed on disk. This must only be called while the
+	// game is not being simulated, e.g. when landed or in the main menu.
+	static void CheckForChanges();
 	
 	// Get the list of resource sources (i.e. plugin folders).
 	static const std::vector<std::string> &Sources();
@@ -110,6 +123,8 @@ public:
 	static const Set<Interface> &Interfaces();
 	static const Set<Minable> &Minables();
 	static const Set<Mission> &Missions();
+	// Get the same missions, sorted by where they can be offered.
+	static const MissionIndex &MissionOffers();
 	static const Set<News> &SpaceportNews();
 	static const Set<Outfit> &Outfits();
 	static const Set<Sale<Outfit>> &Outfitters();
@@ -154,7 +169,11 @@ public:
 private:
 	static void LoadSources();
 	static void LoadFile(const std::string &path, bool debugMode);
+	static void LoadNode(const DataNode &node, const std::string &path);
 	static std::map<std::string, std::shared_ptr<ImageSet>> FindImages();
+	static void ReloadData(const std::vector<std::string> &changedFiles);
+	static void ReloadImages(const std::set<std::string> &names);
+	static void IndexEconomy();
 	
 	static void PrintShipTable();
 	static void PrintTestsTable();
@@ -14,6 +14,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "File.h"
 #include "Files.h"
+#include "PixelKernels.h"
+#include "TextureCache.h"
 
 #include <png.h>
 #include <jpeglib.h>
@@ -27,7 +29,6 @@ using namespace std;
 namespace {
 	bool ReadPNG(const string &path, ImageBuffer &buffer, int frame);
 	bool ReadJPG(const string &path, ImageBuffer &buffer, int frame);
-	void Premultiply(ImageBuffer &buffer, int frame, int additive);
 }
 
 
@@ -126,20 +127,11 @@ void ImageBuffer::ShrinkToHalfSize()
 	ImageBuffer result(frames);
 	result.Allocate(width / 2, height / 2);
 	
-	unsigned char *begin = reinterpret_cast<unsigned char *>(pixels);
-	unsigned char *out = reinterpret_cast<unsigned char *>(result.pixels);
 	// Loop through every line of every frame of the buffer.
 	for(int y = 0; y < result.height * frames; ++y)
 	{
-		unsigned char *aIt = begin + (4 * width) * (2 * y);
-		unsigned char *aEnd = aIt + 4 * 2 * result.width;
-		unsigned char *bIt = begin + (4 * width) * (2 * y + 1);
-		for( ; aIt != aEnd; aIt += 4, bIt += 4)
-		{
-			for(int channel = 0; channel < 4; ++channel, ++aIt, ++bIt, ++out)
-				*out = (static_cast<unsigned>(aIt[0]) + static_cast<unsigned>(bIt[0])
-					+ static_cast<unsigned>(aIt[4]) + static_cast<unsigned>(bIt[4]) + 2) / 4;
-		}
+		const uint32_t *a = pixels + width * (2 * y);
+		PixelKernels::ShrinkRow(a, a + width, result.pixels + result.width * y, result.width);
 	}
 	swap(width, result.width);
 	swap(height, result.height);
@@ -148,6 +140,17 @@ void ImageBuffer::ShrinkToHalfSize()
 
 
 
+// Convert the given frame to premultiplied alpha, or to additive or
+// half-additive color mixing.
+void ImageBuffer::Premultiply(int frame, int additive)
+{
+	// All the rows of one frame are stored one after another.
+	uint32_t *begin = Begin(0, frame);
+	PixelKernels::Premultiply(begin, begin + width * height, additive);
+}
+
+
+
 bool ImageBuffer::Read(const string &path, int frame)
 {
 	// First, make sure this is a JPG or PNG file.
@@ -160,6 +163,10 @@ bool ImageBuffer::Read(const string &path, int frame)
 	if(!isPNG && !isJPG)
 		return false;
 	
+	// If this frame was decoded before, it may be in the texture cache.
+	if(TextureCache::Read(path, *this, frame))
+		return true;
+	
 	if(isPNG && !ReadPNG(path, *this, frame))
 		return false;
 	if(isJPG && !ReadJPG(path, *this, frame))
@@ -179,8 +186,9 @@ bool ImageBuffer::Read(const string &path, int frame)
 	{
 		int additive = (path[pos] == '+') ? 2 : (path[pos] == '~') ? 1 : 0;
 		if(isPNG || (isJPG && additive == 2))
-			Premultiply(*this, frame, additive);
+			Premultiply(frame, additive);
 	}
+	TextureCache::Add(path, *this, frame);
 	return true;
 }
 
@@ -319,32 +327,4 @@ namespace {
 		
 		return true;
 	}
-	
-	
-	
-	void Premultiply(ImageBuffer &buffer, int frame, int additive)
-	{
-		for(int y = 0; y < buffer.Height(); ++y)
-		{
-			uint32_t *it = buffer.Begin(y, frame);
-			
-			for(uint32_t *end = it + buffer.Width(); it != end; ++it)
-			{
-				uint64_t value = *it;
-				uint64_t alpha = (value & 0xFF000000) >> 24;
-				
-				uint64_t red = (((value & 0xFF0000) * alpha) / 255) & 0xFF0000;
-				uint64_t green = (((value & 0xFF00) * alpha) / 255) & 0xFF00;
-				uint64_t blue = (((value & 0xFF) * alpha) / 255) & 0xFF;
-				
-				value = red | green | blue;
-				if(additive == 1)
-					alpha >>= 2;
-				if(additive != 2)
-					value |= (alpha << 24);
-				
-				*it = static_cast<uint32_t>(value);
-			}
-		}
-	}
 }
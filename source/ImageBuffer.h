@@ -50,6 +50,9 @@ public:
 	uint32_t *Begin(int y, int frame = 0);
 	
 	void ShrinkToHalfSize();
+	// Convert the given frame to premultiplied alpha. If "additive" is 1 or 2,
+	// convert it to half-additive or additive color mixing instead.
+	void Premultiply(int frame, int additive);
 	
 	// Read a single frame. Return false if an error is encountered - either the
 	// image is the wrong size, or it is not a supported image format.
@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Files.h"
 #include "Mask.h"
+#include "MaskCache.h"
 #include "Sprite.h"
 
 #include <algorithm>
@@ -216,11 +217,13 @@ void ImageSet::Load() noexcept(false)
 	{
 		if(!buffer[0].Read(paths[0][i], i))
 			Files::LogError("Failed to read image data for \"" + name + "\" frame #" + to_string(i));
-		else if(makeMasks)
+		else if(makeMasks && !MaskCache::Get(paths[0][i], masks[i]))
 		{
 			masks[i].Create(buffer[0], i);
 			if(!masks[i].IsLoaded())
 				Files::LogError("Failed to create collision mask for \"" + name + "\" frame #" + to_string(i));
+			else
+				MaskCache::Add(paths[0][i], masks[i]);
 		}
 	}
 	// Now, load the 2x sprites, if they exist. Because the number of 1x frames
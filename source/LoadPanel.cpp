@@ -402,12 +402,17 @@ bool LoadPanel::Scroll(double dx, double dy)
 
 void LoadPanel::UpdateLists()
 {
+	// Make sure the list reflects any save that is still being written.
+	PlayerInfo::FinishSaving();
 	files.clear();
 	
 	vector<string> fileList = Files::List(Files::Saves());
 	for(const string &path : fileList)
 	{
 		string fileName = Files::Name(path);
+		// Skip anything that is not a saved game, such as a partly written one.
+		if(fileName.length() < 4 || fileName.compare(fileName.length() - 4, 4, ".txt"))
+			continue;
 		// The file name is either "Pilot Name.txt" or "Pilot Name~SnapshotTitle.txt".
 		size_t pos = fileName.find('~');
 		if(pos == string::npos)
@@ -25,7 +25,6 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "System.h"
 
 #include <algorithm>
-#include <mutex>
 
 using namespace std;
 
@@ -69,23 +68,8 @@ namespace {
 	// Check if the given system is within the given distance of the center.
 	int Distance(const System *center, const System *system, int maximum)
 	{
-		// This function should only ever be called from the main thread, but
-		// just to be sure, use mutex protection on the static locals.
-		static mutex distanceMutex;
-		lock_guard<mutex> lock(distanceMutex);
-		
-		static const System *previousCenter = center;
-		static DistanceMap distance(center, -1, maximum);
-		static int previousMaximum = maximum;
-		
-		if(center != previousCenter || maximum > previousMaximum)
-		{
-			previousCenter = center;
-			previousMaximum = maximum;
-			distance = DistanceMap(center, -1, maximum);
-		}
 		// If the distance is greater than the maximum, this is not a match.
-		int d = distance.Days(system);
+		int d = DistanceMap::Jumps(center, system);
 		return (d > maximum) ? -1 : d;
 	}
 	
@@ -311,6 +295,34 @@ bool LocationFilter::IsValid() const
 
 
 
+const set<const Planet *> &LocationFilter::Planets() const
+{
+	return planets;
+}
+
+
+
+const set<const System *> &LocationFilter::Systems() const
+{
+	return systems;
+}
+
+
+
+const set<const Government *> &LocationFilter::Governments() const
+{
+	return governments;
+}
+
+
+
+const list<set<string>> &LocationFilter::Attributes() const
+{
+	return attributes;
+}
+
+
+
 // If the player is in the given system, does this filter match?
 bool LocationFilter::Matches(const Planet *planet, const System *origin) const
 {
@@ -442,16 +454,24 @@ LocationFilter LocationFilter::SetOrigin(const System *origin) const
 // Pick a random system that matches this filter, based on the given origin.
 const System *LocationFilter::PickSystem(const System *origin) const
 {
-	// Find a planet that satisfies the filter.
+	// Find a system that satisfies the filter.
 	vector<const System *> options;
-	for(const auto &it : GameData::Systems())
+	vector<const System *> candidates;
+	if(CandidateSystems(origin, candidates))
 	{
-		// Skip entries with incomplete data.
-		if(!it.second.IsValid())
-			continue;
-		if(Matches(&it.second, origin))
-			options.push_back(&it.second);
+		for(const System *system : candidates)
+			if(system->IsValid() && Matches(system, origin))
+				options.push_back(system);
 	}
+	else
+		for(const auto &it : GameData::Systems())
+		{
+			// Skip entries with incomplete data.
+			if(!it.second.IsValid())
+				continue;
+			if(Matches(&it.second, origin))
+				options.push_back(&it.second);
+		}
 	return options.empty() ? nullptr : options[Random::Int(options.size())];
 }
 
@@ -462,19 +482,47 @@ const Planet *LocationFilter::PickPlanet(const System *origin, bool hasClearance
 {
 	// Find a planet that satisfies the filter.
 	vector<const Planet *> options;
-	for(const auto &it : GameData::Planets())
+	auto check = [&](const Planet &planet) -> void
 	{
-		const Planet &planet = it.second;
 		// Skip entries with incomplete data.
 		if(!planet.IsValid())
-			continue;
+			return;
 		// Skip planets that do not offer special jobs or missions, unless they were explicitly listed as options.
 		if(planet.IsWormhole() || (requireSpaceport && !planet.HasSpaceport()) || (!hasClearance && !planet.CanLand()))
 			if(planets.empty() || !planets.count(&planet))
-				continue;
+				return;
 		if(Matches(&planet, origin))
 			options.push_back(&planet);
+	};
+	
+	// If the filter names the planets or limits which systems they can be in,
+	// only those planets need to be checked.
+	vector<const Planet *> candidates(planets.begin(), planets.end());
+	vector<const System *> systemCandidates;
+	bool hasCandidates = !planets.empty();
+	if(!hasCandidates && CandidateSystems(origin, systemCandidates))
+	{
+		hasCandidates = true;
+		for(const System *system : systemCandidates)
+			for(const StellarObject &object : system->Objects())
+				if(object.GetPlanet())
+					candidates.push_back(object.GetPlanet());
+	}
+	
+	if(hasCandidates)
+	{
+		for(const Planet *planet : candidates)
+			check(*planet);
+		// List the options in the same order that checking every planet would,
+		// so that the same random number picks the same one. A planet may be
+		// in more than one of the systems.
+		sort(options.begin(), options.end(), [](const Planet *a, const Planet *b) -> bool
+			{ return a->TrueName() < b->TrueName(); });
+		options.erase(unique(options.begin(), options.end()), options.end());
 	}
+	else
+		for(const auto &it : GameData::Planets())
+			check(it.second);
 	return options.empty() ? nullptr : options[Random::Int(options.size())];
 }
 
@@ -619,3 +667,29 @@ bool LocationFilter::Matches(const System *system, const System *origin, bool di
 	
 	return true;
 }
+
+
+
+// If this filter only matches planets and systems in certain systems, which can
+// be found without checking every system, get those systems and return true.
+// They are listed in the same order as in GameData::Systems().
+bool LocationFilter::CandidateSystems(const System *origin, vector<const System *> &result) const
+{
+	if(!systems.empty())
+	{
+		for(const auto &it : GameData::Systems())
+			if(systems.count(&it.second))
+				result.push_back(&it.second);
+		return true;
+	}
+	
+	const System *from = (center ? center : originMaxDistance >= 0 ? origin : nullptr);
+	if(!from)
+		return false;
+	
+	DistanceMap distance(from, -1, center ? centerMaxDistance : originMaxDistance);
+	for(const auto &it : GameData::Systems())
+		if(distance.HasRoute(&it.second))
+			result.push_back(&it.second);
+	return true;
+}
@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 class DataNode;
 class DataWriter;
@@ -46,6 +47,13 @@ public:
 	// Check if this filter contains any specifications.
 	bool IsEmpty() const;
 	bool IsValid() const;
+	// Get the planets, systems, governments, and sets of attributes that a
+	// planet must belong to or have in order to match this filter. An empty
+	// set means that any value matches.
+	const std::set<const Planet *> &Planets() const;
+	const std::set<const System *> &Systems() const;
+	const std::set<const Government *> &Governments() const;
+	const std::list<std::set<std::string>> &Attributes() const;
 	
 	// If the player is in the given system, does this filter match?
 	bool Matches(const Planet *planet, const System *origin = nullptr) const;
@@ -70,6 +78,9 @@ private:
 	// only if the filter wasn't looking for planet characteristics or if the
 	// didPlanet argument is set (meaning we already checked those).
 	bool Matches(const System *system, const System *origin, bool didPlanet) const;
+	// If this filter only matches planets and systems in certain systems, which
+	// can be found without checking every system, get those systems.
+	bool CandidateSystems(const System *origin, std::vector<const System *> &result) const;
 	
 	
 private:
@@ -137,7 +137,11 @@ void MainPanel::Step()
 	if(isActive)
 		engine.Go();
 	else
+	{
 		canDrag = false;
+		// The game is paused, so it is safe to reload any changed data.
+		GameData::CheckForChanges();
+	}
 	canClick = isActive;
 }
 
@@ -300,6 +300,17 @@ void Mask::Create(const ImageBuffer &image, int frame)
 
 
 
+// Construct a mask from outlines that were generated previously.
+void Mask::Create(vector<vector<Point>> outlines)
+{
+	this->outlines = move(outlines);
+	radius = 0.;
+	for(const auto &outline : this->outlines)
+		radius = max(radius, ComputeRadius(outline));
+}
+
+
+
 // Check whether a mask was successfully generated from the image.
 bool Mask::IsLoaded() const
 {
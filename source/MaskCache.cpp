@@ -0,0 +1,234 @@
+/* MaskCache.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "MaskCache.h"
+
+#include "Files.h"
+#include "Mask.h"
+#include "Point.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Change this whenever the format of the cache file or the algorithm for
+	// generating the masks changes, so that old cache files are ignored.
+	const string HEADER = "mask cache 1";
+	
+	struct Entry {
+		time_t timestamp = 0;
+		vector<vector<Point>> outlines;
+		bool isUsed = false;
+	};
+	
+	mutex cacheMutex;
+	map<string, Entry> entries;
+	bool isChanged = false;
+	
+	string CachePath()
+	{
+		return Files::Config() + "mask cache.txt";
+	}
+	
+	// Read one line, without its line ending.
+	bool ReadLine(const string &data, size_t &pos, string &line)
+	{
+		if(pos >= data.size())
+			return false;
+		
+		size_t end = data.find('\n', pos);
+		if(end == string::npos)
+			return false;
+		
+		line.assign(data, pos, end - pos);
+		if(!line.empty() && line.back() == '\r')
+			line.pop_back();
+		pos = end + 1;
+		return true;
+	}
+	
+	// Read one number from a line. The numbers are written as hexadecimal
+	// floating point, so that they are read back exactly as they were written.
+	bool ReadNumber(const char *&it, double &value)
+	{
+		char *end = nullptr;
+		value = strtod(it, &end);
+		if(end == it)
+			return false;
+		
+		it = end;
+		return true;
+	}
+	
+	bool ReadCount(const char *&it, size_t &count)
+	{
+		double value = 0.;
+		if(!ReadNumber(it, value) || value < 0. || value > 1e6 || value != static_cast<size_t>(value))
+			return false;
+		
+		count = static_cast<size_t>(value);
+		return true;
+	}
+	
+	// Parse the whole cache file. If any part of it is invalid, the whole file
+	// is ignored.
+	bool Parse(const string &data, map<string, Entry> &result)
+	{
+		size_t pos = 0;
+		string line;
+		if(!ReadLine(data, pos, line) || line != HEADER)
+			return false;
+		
+		// Each entry is the image path on one line, then its timestamp and the
+		// number of outlines, then one line per outline listing its points.
+		string path;
+		while(ReadLine(data, pos, path))
+		{
+			if(path.empty() || !ReadLine(data, pos, line))
+				return false;
+			
+			const char *it = line.c_str();
+			double timestamp = 0.;
+			size_t count = 0;
+			if(!ReadNumber(it, timestamp) || !ReadCount(it, count))
+				return false;
+			
+			Entry &entry = result[path];
+			entry.timestamp = timestamp;
+			entry.outlines.resize(count);
+			for(vector<Point> &outline : entry.outlines)
+			{
+				if(!ReadLine(data, pos, line))
+					return false;
+				
+				it = line.c_str();
+				size_t points = 0;
+				if(!ReadCount(it, points) || points < 3)
+					return false;
+				
+				outline.reserve(points);
+				for(size_t i = 0; i < points; ++i)
+				{
+					double x = 0.;
+					double y = 0.;
+					if(!ReadNumber(it, x) || !ReadNumber(it, y))
+						return false;
+					outline.emplace_back(x, y);
+				}
+			}
+		}
+		return true;
+	}
+}
+
+
+
+// Read the cache file. If it is missing, corrupt, or from a different
+// version of the cache format, start with an empty cache.
+void MaskCache::Load()
+{
+	lock_guard<mutex> lock(cacheMutex);
+	entries.clear();
+	isChanged = false;
+	
+	string data = Files::Read(CachePath());
+	if(data.empty())
+		return;
+	
+	if(!Parse(data, entries))
+	{
+		Files::LogError("Ignoring the collision mask cache because it is invalid or out of date.");
+		entries.clear();
+		isChanged = true;
+	}
+}
+
+
+
+// Get the cached mask for the given image, if it has not been modified
+// since the mask was generated.
+bool MaskCache::Get(const string &path, Mask &mask)
+{
+	time_t timestamp = Files::Timestamp(path);
+	
+	lock_guard<mutex> lock(cacheMutex);
+	auto it = entries.find(path);
+	if(it == entries.end() || it->second.timestamp != timestamp || it->second.outlines.empty())
+		return false;
+	
+	it->second.isUsed = true;
+	mask.Create(it->second.outlines);
+	return true;
+}
+
+
+
+// Remember the mask generated from the given image.
+void MaskCache::Add(const string &path, const Mask &mask)
+{
+	time_t timestamp = Files::Timestamp(path);
+	
+	lock_guard<mutex> lock(cacheMutex);
+	Entry &entry = entries[path];
+	entry.timestamp = timestamp;
+	entry.outlines = mask.Outlines();
+	entry.isUsed = true;
+	isChanged = true;
+}
+
+
+
+// Write the cache file, if any masks were added. Only the masks that were
+// used since the cache was loaded are kept.
+void MaskCache::Save()
+{
+	lock_guard<mutex> lock(cacheMutex);
+	for(auto it = entries.begin(); it != entries.end(); )
+	{
+		if(it->second.isUsed)
+			++it;
+		else
+		{
+			it = entries.erase(it);
+			isChanged = true;
+		}
+	}
+	if(!isChanged)
+		return;
+	
+	string out = HEADER + '\n';
+	char buffer[64];
+	for(const auto &it : entries)
+	{
+		out += it.first + '\n';
+		snprintf(buffer, sizeof(buffer), "%.0f %zu\n", static_cast<double>(it.second.timestamp), it.second.outlines.size());
+		out += buffer;
+		for(const vector<Point> &outline : it.second.outlines)
+		{
+			out += to_string(outline.size());
+			for(const Point &point : outline)
+			{
+				snprintf(buffer, sizeof(buffer), " %a %a", point.X(), point.Y());
+				out += buffer;
+			}
+			out += '\n';
+		}
+	}
+	Files::Write(CachePath(), out);
+	isChanged = false;
+}
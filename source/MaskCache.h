@@ -0,0 +1,44 @@
+/* MaskCache.h
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef MASK_CACHE_H_
+#define MASK_CACHE_H_
+
+#include <string>
+
+class Mask;
+
+
+
+// Class for storing the collision masks generated from each image in a file
+// in the config directory, so that they do not have to be traced again every
+// time the game starts. Each mask is identified by the path and modification
+// time of the image it was generated from. Get() and Add() may be called from
+// any of the image-loading threads.
+class MaskCache {
+public:
+	// Read the cache file. If it is missing, corrupt, or from a different
+	// version of the cache format, start with an empty cache.
+	static void Load();
+	// Get the cached mask for the given image, if it has not been modified
+	// since the mask was generated.
+	static bool Get(const std::string &path, Mask &mask);
+	// Remember the mask generated from the given image.
+	static void Add(const std::string &path, const Mask &mask);
+	// Write the cache file, if any masks were added. Only the masks that were
+	// used since the cache was loaded are kept.
+	static void Save();
+};
+
+
+
+#endif
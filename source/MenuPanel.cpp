@@ -70,6 +70,8 @@ void MenuPanel::Step()
 			scroll = 0;
 	}
 	progress = static_cast<int>(GameData::Progress() * 60.);
+	if(GameData::IsLoaded())
+		GameData::CheckForChanges();
 	if(GameData::IsLoaded() && gamePanels.IsEmpty())
 	{
 		gamePanels.Push(new MainPanel(player));
@@ -517,6 +517,20 @@ bool Mission::IsAtLocation(Location location) const
 
 
 
+const Planet *Mission::Source() const
+{
+	return source;
+}
+
+
+
+const LocationFilter &Mission::SourceFilter() const
+{
+	return sourceFilter;
+}
+
+
+
 // Information about what you are doing.
 const Planet *Mission::Destination() const
 {
@@ -675,8 +689,7 @@ bool Mission::CanOffer(const PlayerInfo &player, const shared_ptr<Ship> &boardin
 	
 	if(repeat)
 	{
-		auto cit = player.Conditions().find(name + ": offered");
-		if(cit != player.Conditions().end() && cit->second >= repeat)
+		if(player.Conditions().Get(name + ": offered") >= repeat)
 			return false;
 	}
 	
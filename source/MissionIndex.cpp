@@ -0,0 +1,119 @@
+/* MissionIndex.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "MissionIndex.h"
+
+#include "LocationFilter.h"
+#include "Mission.h"
+#include "Planet.h"
+
+#include <algorithm>
+#include <list>
+#include <set>
+
+using namespace std;
+
+namespace {
+	// Append the indices filed under the given key, if there are any.
+	template <class Key>
+	void Append(const map<Key, vector<size_t>> &index, const Key &key, vector<size_t> &result)
+	{
+		auto it = index.find(key);
+		if(it != index.end())
+			result.insert(result.end(), it->second.begin(), it->second.end());
+	}
+}
+
+
+
+// Sort the given missions by where they can be offered.
+void MissionIndex::Build(const Set<Mission> &missions)
+{
+	*this = MissionIndex();
+	
+	for(const auto &it : missions)
+	{
+		const Mission &mission = it.second;
+		if(mission.IsAtLocation(Mission::BOARDING) || mission.IsAtLocation(Mission::ASSISTING))
+		{
+			boarding.push_back(&mission);
+			continue;
+		}
+		
+		size_t index = landing.size();
+		landing.push_back(&mission);
+		
+		// File this mission under the requirement that matches the fewest
+		// planets. A planet only matches a filter if its attributes include at
+		// least one from each set, so any one of those sets will do; use the
+		// smallest one so the mission is filed under as few keys as possible.
+		const LocationFilter &filter = mission.SourceFilter();
+		const set<string> *attributes = nullptr;
+		for(const set<string> &attributeSet : filter.Attributes())
+			if(!attributes || attributeSet.size() < attributes->size())
+				attributes = &attributeSet;
+		
+		if(mission.Source())
+			byPlanet[mission.Source()].push_back(index);
+		else if(!filter.Planets().empty())
+			for(const Planet *planet : filter.Planets())
+				byPlanet[planet].push_back(index);
+		else if(!filter.Systems().empty())
+			for(const System *system : filter.Systems())
+				bySystem[system].push_back(index);
+		else if(!filter.Governments().empty())
+			for(const Government *government : filter.Governments())
+				byGovernment[government].push_back(index);
+		else if(attributes)
+			for(const string &attribute : *attributes)
+				byAttribute[attribute].push_back(index);
+		else
+			anywhere.push_back(index);
+	}
+}
+
+
+
+// Get every mission that might be offered when landing on the given planet,
+// in the same order as in the set they came from.
+vector<const Mission *> MissionIndex::Landing(const Planet *planet) const
+{
+	vector<const Mission *> result;
+	// A mission's source filter never matches if there is no planet.
+	if(!planet)
+		return result;
+	
+	vector<size_t> indices = anywhere;
+	Append(byPlanet, planet, indices);
+	Append(bySystem, planet->GetSystem(), indices);
+	Append(byGovernment, planet->GetGovernment(), indices);
+	for(const string &attribute : planet->Attributes())
+		Append(byAttribute, attribute, indices);
+	
+	// A mission filed under several attributes may have been found more than
+	// once, and the missions must be offered in their original order.
+	sort(indices.begin(), indices.end());
+	indices.erase(unique(indices.begin(), indices.end()), indices.end());
+	
+	result.reserve(indices.size());
+	for(size_t index : indices)
+		result.push_back(landing[index]);
+	return result;
+}
+
+
+
+// Get every mission that is offered when boarding or assisting a ship.
+const vector<const Mission *> &MissionIndex::Boarding() const
+{
+	return boarding;
+}
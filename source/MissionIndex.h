@@ -0,0 +1,64 @@
+/* MissionIndex.h
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef MISSION_INDEX_H_
+#define MISSION_INDEX_H_
+
+#include "Set.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+class Government;
+class Mission;
+class Planet;
+class System;
+
+
+
+// An index of all the missions in the game data, sorted by where they can be
+// offered. Most missions can only be offered on a particular planet, or in a
+// particular system, or on planets belonging to a particular government or
+// having a particular attribute. Those requirements never change, even if the
+// planet's system, government, or attributes do, so a mission only needs to be
+// considered when the player lands somewhere that currently meets them.
+class MissionIndex {
+public:
+	// Sort the given missions by where they can be offered.
+	void Build(const Set<Mission> &missions);
+	
+	// Get every mission that might be offered when landing on the given planet,
+	// in the same order as in the set they came from. Each one must still be
+	// checked with Mission::CanOffer() to see if it can actually be offered.
+	std::vector<const Mission *> Landing(const Planet *planet) const;
+	// Get every mission that is offered when boarding or assisting a ship.
+	const std::vector<const Mission *> &Boarding() const;
+	
+	
+private:
+	// Every mission that is offered on a planet, in order. The indices of them
+	// are filed under whichever requirement of theirs is the most specific.
+	std::vector<const Mission *> landing;
+	std::vector<size_t> anywhere;
+	std::map<const Planet *, std::vector<size_t>> byPlanet;
+	std::map<const System *, std::vector<size_t>> bySystem;
+	std::map<const Government *, std::vector<size_t>> byGovernment;
+	std::map<std::string, std::vector<size_t>> byAttribute;
+	
+	std::vector<const Mission *> boarding;
+};
+
+
+
+#endif
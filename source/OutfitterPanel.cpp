@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "text/alignment.hpp"
 #include "Color.h"
+#include "ConditionsStore.h"
 #include "Dialog.h"
 #include "text/DisplayText.h"
 #include "DistanceMap.h"
@@ -58,10 +59,10 @@ OutfitterPanel::OutfitterPanel(PlayerInfo &player)
 	
 	// Add owned licenses
 	const string PREFIX = "license: ";
-	for(auto &it : player.Conditions())
-		if(it.first.compare(0, PREFIX.length(), PREFIX) == 0 && it.second > 0)
+	for(int id : player.Conditions().Ids(PREFIX))
+		if(player.Conditions().Get(id) > 0)
 		{
-			const string name = it.first.substr(PREFIX.length()) + " License";
+			const string name = ConditionsStore::Name(id).substr(PREFIX.length()) + " License";
 			const Outfit *outfit = GameData::Outfits().Get(name);
 			if(outfit)
 				catalog[outfit->Category()].insert(name);
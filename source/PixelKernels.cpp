@@ -0,0 +1,248 @@
+/* PixelKernels.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "PixelKernels.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+// With GCC and Clang, AVX2 versions of the image conversions are also built,
+// and are used if the processor supports them.
+#ifdef __GNUC__
+#define PIXEL_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+using namespace std;
+
+namespace {
+#ifdef __SSE2__
+	// Get the bits of a pixel that hold its alpha after conversion, once the
+	// pixel has been shifted right by 2 bits for half-additive mixing.
+	uint32_t AlphaMask(int additive)
+	{
+		return (additive == 2) ? 0 : (additive == 1) ? 0x3F000000 : 0xFF000000;
+	}
+#endif
+	
+	
+	
+#ifdef PIXEL_KERNELS_AVX2
+	bool HasAVX2()
+	{
+		static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+		return hasAVX2;
+	}
+#endif
+	
+	
+	
+#ifdef PIXEL_KERNELS_AVX2
+	// Convert eight pixels at a time. Return a pointer to the first pixel that
+	// was not converted.
+	__attribute__((target("avx2")))
+	uint32_t *PremultiplyAVX2(uint32_t *it, uint32_t *end, int additive)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i one = _mm256_set1_epi16(1);
+		const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+		const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(AlphaMask(additive)));
+		const __m128i alphaShift = _mm_cvtsi32_si128(additive == 1 ? 2 : 0);
+		for( ; end - it >= 8; it += 8)
+		{
+			__m256i *pixels = reinterpret_cast<__m256i *>(it);
+			__m256i value = _mm256_loadu_si256(pixels);
+			__m256i color[2] = {_mm256_unpacklo_epi8(value, zero), _mm256_unpackhi_epi8(value, zero)};
+			for(__m256i &channels : color)
+			{
+				// Multiply each channel by its pixel's alpha, then divide by 255,
+				// rounding down. The division is exact for any product of two
+				// 8-bit values.
+				__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				channels = _mm256_mullo_epi16(channels, alpha);
+				channels = _mm256_add_epi16(channels, _mm256_add_epi16(one, _mm256_srli_epi16(channels, 8)));
+				channels = _mm256_srli_epi16(channels, 8);
+			}
+			__m256i result = _mm256_and_si256(_mm256_packus_epi16(color[0], color[1]), colorMask);
+			result = _mm256_or_si256(result, _mm256_and_si256(_mm256_srl_epi32(value, alphaShift), alphaMask));
+			_mm256_storeu_si256(pixels, result);
+		}
+		return it;
+	}
+#endif
+	
+	
+	
+#ifdef __SSE2__
+	// Convert four pixels at a time. Return a pointer to the first pixel that
+	// was not converted.
+	uint32_t *PremultiplySSE2(uint32_t *it, uint32_t *end, int additive)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi16(1);
+		const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(AlphaMask(additive)));
+		const __m128i alphaShift = _mm_cvtsi32_si128(additive == 1 ? 2 : 0);
+		for( ; end - it >= 4; it += 4)
+		{
+			__m128i *pixels = reinterpret_cast<__m128i *>(it);
+			__m128i value = _mm_loadu_si128(pixels);
+			__m128i color[2] = {_mm_unpacklo_epi8(value, zero), _mm_unpackhi_epi8(value, zero)};
+			for(__m128i &channels : color)
+			{
+				__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				channels = _mm_mullo_epi16(channels, alpha);
+				channels = _mm_add_epi16(channels, _mm_add_epi16(one, _mm_srli_epi16(channels, 8)));
+				channels = _mm_srli_epi16(channels, 8);
+			}
+			__m128i result = _mm_and_si128(_mm_packus_epi16(color[0], color[1]), colorMask);
+			result = _mm_or_si128(result, _mm_and_si128(_mm_srl_epi32(value, alphaShift), alphaMask));
+			_mm_storeu_si128(pixels, result);
+		}
+		return it;
+	}
+#endif
+	
+	
+	
+#ifdef PIXEL_KERNELS_AVX2
+	// Average each 2x2 block of pixels in the given eight columns of two rows,
+	// giving four pixels with 16 bits per channel. The two pixels from the
+	// first four columns are in the low half of each 128-bit lane.
+	__attribute__((target("avx2")))
+	__m256i ShrinkAVX2(const uint32_t *a, const uint32_t *b)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i rowA = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+		__m256i rowB = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+		__m256i low = _mm256_add_epi16(_mm256_unpacklo_epi8(rowA, zero), _mm256_unpacklo_epi8(rowB, zero));
+		__m256i high = _mm256_add_epi16(_mm256_unpackhi_epi8(rowA, zero), _mm256_unpackhi_epi8(rowB, zero));
+		low = _mm256_add_epi16(low, _mm256_srli_si256(low, 8));
+		high = _mm256_add_epi16(high, _mm256_srli_si256(high, 8));
+		__m256i sum = _mm256_unpacklo_epi64(low, high);
+		return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+	}
+	
+	
+	
+	// Shrink eight output pixels at a time. Return the number of output pixels
+	// that were done.
+	__attribute__((target("avx2")))
+	int ShrinkRowAVX2(const uint32_t *a, const uint32_t *b, uint32_t *out, int width)
+	{
+		int x = 0;
+		for( ; width - x >= 8; x += 8)
+		{
+			__m256i first = ShrinkAVX2(a + 2 * x, b + 2 * x);
+			__m256i second = ShrinkAVX2(a + 2 * x + 8, b + 2 * x + 8);
+			// Packing interleaves the two inputs' 128-bit lanes, so put the
+			// pixels back in order.
+			__m256i result = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + x), result);
+		}
+		return x;
+	}
+#endif
+	
+	
+	
+#ifdef __SSE2__
+	// Average each 2x2 block of pixels in the given four columns of two rows,
+	// giving two pixels with 16 bits per channel.
+	__m128i ShrinkSSE2(const uint32_t *a, const uint32_t *b)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		__m128i rowA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+		__m128i rowB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+		__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(rowA, zero), _mm_unpacklo_epi8(rowB, zero));
+		__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(rowA, zero), _mm_unpackhi_epi8(rowB, zero));
+		low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+		high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+		__m128i sum = _mm_unpacklo_epi64(low, high);
+		return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+	}
+	
+	
+	
+	// Shrink four output pixels at a time. Return the number of output pixels
+	// that were done.
+	int ShrinkRowSSE2(const uint32_t *a, const uint32_t *b, uint32_t *out, int width)
+	{
+		int x = 0;
+		for( ; width - x >= 4; x += 4)
+		{
+			__m128i first = ShrinkSSE2(a + 2 * x, b + 2 * x);
+			__m128i second = ShrinkSSE2(a + 2 * x + 4, b + 2 * x + 4);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), _mm_packus_epi16(first, second));
+		}
+		return x;
+	}
+#endif
+}
+
+
+
+// Convert a range of pixels to premultiplied alpha, or to additive or
+// half-additive color mixing.
+void PixelKernels::Premultiply(uint32_t *it, uint32_t *end, int additive)
+{
+#ifdef PIXEL_KERNELS_AVX2
+	if(HasAVX2())
+		it = PremultiplyAVX2(it, end, additive);
+#endif
+#ifdef __SSE2__
+	it = PremultiplySSE2(it, end, additive);
+#endif
+	for( ; it != end; ++it)
+	{
+		uint64_t value = *it;
+		uint64_t alpha = (value & 0xFF000000) >> 24;
+		
+		uint64_t red = (((value & 0xFF0000) * alpha) / 255) & 0xFF0000;
+		uint64_t green = (((value & 0xFF00) * alpha) / 255) & 0xFF00;
+		uint64_t blue = (((value & 0xFF) * alpha) / 255) & 0xFF;
+		
+		value = red | green | blue;
+		if(additive == 1)
+			alpha >>= 2;
+		if(additive != 2)
+			value |= (alpha << 24);
+		
+		*it = static_cast<uint32_t>(value);
+	}
+}
+
+
+
+// Shrink a pair of rows into a single row of the given width, averaging
+// each 2x2 block of pixels.
+void PixelKernels::ShrinkRow(const uint32_t *a, const uint32_t *b, uint32_t *out, int width)
+{
+	int x = 0;
+#ifdef PIXEL_KERNELS_AVX2
+	if(HasAVX2())
+		x = ShrinkRowAVX2(a, b, out, width);
+#endif
+#ifdef __SSE2__
+	x += ShrinkRowSSE2(a + 2 * x, b + 2 * x, out + x, width - x);
+#endif
+	const unsigned char *aIt = reinterpret_cast<const unsigned char *>(a + 2 * x);
+	const unsigned char *aEnd = reinterpret_cast<const unsigned char *>(a + 2 * width);
+	const unsigned char *bIt = reinterpret_cast<const unsigned char *>(b + 2 * x);
+	unsigned char *outIt = reinterpret_cast<unsigned char *>(out + x);
+	for( ; aIt != aEnd; aIt += 4, bIt += 4)
+	{
+		for(int channel = 0; channel < 4; ++channel, ++aIt, ++bIt, ++outIt)
+			*outIt = (static_cast<unsigned>(aIt[0]) + static_cast<unsigned>(bIt[0])
+				+ static_cast<unsigned>(aIt[4]) + static_cast<unsigned>(bIt[4]) + 2) / 4;
+	}
+}
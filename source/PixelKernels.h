@@ -0,0 +1,36 @@
+/* PixelKernels.h
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef PIXEL_KERNELS_H_
+#define PIXEL_KERNELS_H_
+
+#include <cstdint>
+
+
+
+// Functions that transform runs of 32-bit RGBA pixels, for converting images
+// once they have been read from disk. They use SIMD instructions where they
+// are available, but the results are always the same as the plain loops.
+class PixelKernels {
+public:
+	// Convert a range of pixels to premultiplied alpha. If "additive" is 1 or
+	// 2, convert them to half-additive or additive color mixing instead.
+	static void Premultiply(uint32_t *begin, uint32_t *end, int additive);
+	// Shrink a pair of rows into a single row of the given width. Each output
+	// pixel is the rounded average of a 2x2 block of the input pixels, so the
+	// input rows must each be at least twice that width.
+	static void ShrinkRow(const uint32_t *a, const uint32_t *b, uint32_t *out, int width);
+};
+
+
+
+#endif
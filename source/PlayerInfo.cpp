@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "PlayerInfo.h"
 
 #include "Audio.h"
+#include "BinaryData.h"
 #include "ConversationPanel.h"
 #include "DataFile.h"
 #include "DataWriter.h"
@@ -24,6 +25,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Hardpoint.h"
 #include "Messages.h"
 #include "Mission.h"
+#include "MissionIndex.h"
 #include "Outfit.h"
 #include "Person.h"
 #include "Planet.h"
@@ -33,6 +35,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "SavedGame.h"
 #include "Ship.h"
 #include "ShipEvent.h"
+#include "Sprite.h"
 #include "StartConditions.h"
 #include "StellarObject.h"
 #include "System.h"
@@ -45,9 +48,56 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 
 using namespace std;
 
+namespace {
+	// Saved games are written to disk on this thread, so that the game does
+	// not pause while the old save is examined and the new one is written.
+	thread saveThread;
+	
+	// Get the date stored in a saved game, without loading anything else.
+	string SavedDate(const string &path)
+	{
+		istringstream in(SavedGame::ReadHeader(path));
+		DataFile file(in);
+		for(const DataNode &node : file)
+			if(node.Token(0) == "date" && node.Size() >= 4)
+				return Date(node.Value(1), node.Value(2), node.Value(3)).ToString();
+		return string();
+	}
+	
+	// Write out a saved game that has already been composed in memory. If a
+	// backup is wanted and the save is for a new date, the older copies of
+	// this save are each moved back by one first.
+	void WriteSave(const string &path, const string &contents, bool backUp, const string &date)
+	{
+		if(backUp && path.rfind(".txt") == path.length() - 4 && Files::Exists(path)
+				&& SavedDate(path) != date)
+		{
+			string root = path.substr(0, path.length() - 4);
+			string files[4] = {
+				root + "~~previous-3.txt",
+				root + "~~previous-2.txt",
+				root + "~~previous-1.txt",
+				path
+			};
+			for(int i = 0; i < 3; ++i)
+				if(Files::Exists(files[i + 1]))
+					Files::Move(files[i + 1], files[i]);
+		}
+		
+		if(!Files::WriteAtomically(path, contents, BinaryData::IsBinary(contents)))
+		{
+			Files::LogError("Unable to save the game to \"" + path + "\".");
+			Messages::Add("Error: unable to save the game. Check the errors file for details.",
+				Messages::Importance::High);
+		}
+	}
+}
+
+
 
 
 // Completely clear all loaded information, to prepare for loading a file or
@@ -117,6 +167,9 @@ void PlayerInfo::New(const StartConditions &start)
 // Load player information from a saved game file.
 void PlayerInfo::Load(const string &path)
 {
+	// If this file is still being written, wait for it to be finished.
+	FinishSaving();
+	
 	// Make sure any previously loaded data is cleared.
 	Clear();
 	
@@ -339,26 +392,18 @@ void PlayerInfo::Save() const
 	// Remember that this was the most recently saved player.
 	Files::Write(Files::Config() + "recent.txt", filePath + '\n');
 	
-	if(filePath.rfind(".txt") == filePath.length() - 4)
-	{
-		// Only update the backups if this save will have a newer date.
-		SavedGame saved(filePath);
-		if(saved.GetDate() != date.ToString())
-		{
-			string root = filePath.substr(0, filePath.length() - 4);
-			string files[4] = {
-				root + "~~previous-3.txt",
-				root + "~~previous-2.txt",
-				root + "~~previous-1.txt",
-				filePath
-			};
-			for(int i = 0; i < 3; ++i)
-				if(Files::Exists(files[i + 1]))
-					Files::Move(files[i + 1], files[i]);
-		}
-	}
-		
-	Save(filePath);
+	// Only update the backups if this save will have a newer date.
+	Save(filePath, true);
+}
+
+
+
+// Wait for any saved game that is being written in the background to be
+// completely written to disk.
+void PlayerInfo::FinishSaving()
+{
+	if(saveThread.joinable())
+		saveThread.join();
 }
 
 
@@ -554,11 +599,8 @@ void PlayerInfo::IncrementDate()
 	int64_t total[2] = {0, 0};
 	static const string prefix[2] = {"salary: ", "tribute: "};
 	for(int i = 0; i < 2; ++i)
-	{
-		auto it = conditions.lower_bound(prefix[i]);
-		for( ; it != conditions.end() && !it->first.compare(0, prefix[i].length(), prefix[i]); ++it)
-			total[i] += it->second;
-	}
+		for(int id : conditions.Ids(prefix[i]))
+			total[i] += conditions.Get(id);
 	if(total[0] || total[1])
 	{
 		string message = "You receive ";
@@ -1630,10 +1672,10 @@ Mission *PlayerInfo::BoardingMission(const shared_ptr<Ship> &ship)
 			? Mission::BOARDING : Mission::ASSISTING);
 	
 	// Check for available boarding or assisting missions.
-	for(const auto &it : GameData::Missions())
-		if(it.second.IsAtLocation(location) && it.second.CanOffer(*this, ship))
+	for(const Mission *mission : GameData::MissionOffers().Boarding())
+		if(mission->IsAtLocation(location) && mission->CanOffer(*this, ship))
 		{
-			boardingMissions.push_back(it.second.Instantiate(*this, ship));
+			boardingMissions.push_back(mission->Instantiate(*this, ship));
 			if(boardingMissions.back().HasFailed(*this))
 				boardingMissions.pop_back();
 			else
@@ -1801,14 +1843,13 @@ void PlayerInfo::HandleEvent(const ShipEvent &event, UI *ui)
 // Get the value of the given condition (default 0).
 int64_t PlayerInfo::GetCondition(const string &name) const
 {
-	auto it = conditions.find(name);
-	return (it == conditions.end()) ? 0 : it->second;
+	return conditions.Get(name);
 }
 
 
 
 // Get mutable access to the player's list of conditions.
-map<string, int64_t> &PlayerInfo::Conditions()
+ConditionsStore &PlayerInfo::Conditions()
 {
 	return conditions;
 }
@@ -1816,7 +1857,7 @@ map<string, int64_t> &PlayerInfo::Conditions()
 
 
 // Access the player's list of conditions.
-const map<string, int64_t> &PlayerInfo::Conditions() const
+const ConditionsStore &PlayerInfo::Conditions() const
 {
 	return conditions;
 }
@@ -2390,12 +2431,9 @@ void PlayerInfo::ApplyChanges()
 	
 	// Check which planets you have dominated.
 	static const string prefix = "tribute: ";
-	for(auto it = conditions.lower_bound(prefix); it != conditions.end(); ++it)
+	for(int id : conditions.Ids(prefix))
 	{
-		if(it->first.compare(0, prefix.length(), prefix))
-			break;
-		
-		const Planet *planet = GameData::Planets().Find(it->first.substr(prefix.length()));
+		const Planet *planet = GameData::Planets().Find(ConditionsStore::Name(id).substr(prefix.length()));
 		if(planet)
 			GameData::GetPolitics().DominatePlanet(planet);
 	}
@@ -2523,56 +2561,68 @@ void PlayerInfo::ValidateLoad()
 // Update the conditions that reflect the current status of the player.
 void PlayerInfo::UpdateAutoConditions(bool isBoarding)
 {
+	// The IDs of the conditions that are set here only need to be looked up
+	// once, rather than every time the player lands or boards a ship.
+	static const int NET_WORTH = ConditionsStore::Id("net worth");
+	static const int CREDITS = ConditionsStore::Id("credits");
+	static const int UNPAID_MORTGAGES = ConditionsStore::Id("unpaid mortgages");
+	static const int UNPAID_FINES = ConditionsStore::Id("unpaid fines");
+	static const int UNPAID_SALARIES = ConditionsStore::Id("unpaid salaries");
+	static const int UNPAID_MAINTENANCE = ConditionsStore::Id("unpaid maintenance");
+	static const int CREDIT_SCORE = ConditionsStore::Id("credit score");
+	static const int CARGO_SPACE = ConditionsStore::Id("cargo space");
+	static const int PASSENGER_SPACE = ConditionsStore::Id("passenger space");
+	static const int FLAGSHIP_CREW = ConditionsStore::Id("flagship crew");
+	static const int FLAGSHIP_REQUIRED_CREW = ConditionsStore::Id("flagship required crew");
+	static const int FLAGSHIP_BUNKS = ConditionsStore::Id("flagship bunks");
+	static const int CARGO_ATTRACTIVENESS = ConditionsStore::Id("cargo attractiveness");
+	static const int ARMAMENT_DETERRENCE = ConditionsStore::Id("armament deterrence");
+	static const int PIRATE_ATTRACTION = ConditionsStore::Id("pirate attraction");
+	
 	// Bound financial conditions to +/- 4.6 x 10^18 credits, within the range of a 64-bit int.
 	static constexpr int64_t limit = static_cast<int64_t>(1) << 62;
-	conditions["net worth"] = min(limit, max(-limit, accounts.NetWorth()));
-	conditions["credits"] = min(limit, accounts.Credits());
-	conditions["unpaid mortgages"] = min(limit, accounts.TotalDebt("Mortgage"));
-	conditions["unpaid fines"] = min(limit, accounts.TotalDebt("Fine"));
-	conditions["unpaid salaries"] = min(limit, accounts.SalariesOwed());
-	conditions["unpaid maintenance"] = min(limit, accounts.MaintenanceDue());
-	conditions["credit score"] = accounts.CreditScore();
+	conditions[NET_WORTH] = min(limit, max(-limit, accounts.NetWorth()));
+	conditions[CREDITS] = min(limit, accounts.Credits());
+	conditions[UNPAID_MORTGAGES] = min(limit, accounts.TotalDebt("Mortgage"));
+	conditions[UNPAID_FINES] = min(limit, accounts.TotalDebt("Fine"));
+	conditions[UNPAID_SALARIES] = min(limit, accounts.SalariesOwed());
+	conditions[UNPAID_MAINTENANCE] = min(limit, accounts.MaintenanceDue());
+	conditions[CREDIT_SCORE] = accounts.CreditScore();
 	// Serialize the current reputation with other governments.
 	SetReputationConditions();
-	// Helper lambda function to clear a range
-	auto clearRange = [](map<string, int64_t> &conditionsMap, string firstStr, string lastStr)
-	{
-		auto first = conditionsMap.lower_bound(firstStr);
-		auto last = conditionsMap.lower_bound(lastStr);
-		if(first != last)
-			conditionsMap.erase(first, last);
-	};
-	// Clear any existing ships: conditions. (Note: '!' = ' ' + 1.)
-	clearRange(conditions, "ships: ", "ships:!");
+	// Clear any existing ships: conditions.
+	conditions.ErasePrefix("ships: ");
 	// Store special conditions for cargo and passenger space.
-	conditions["cargo space"] = 0;
-	conditions["passenger space"] = 0;
+	int64_t cargoSpace = 0;
+	int64_t passengerSpace = 0;
 	for(const shared_ptr<Ship> &ship : ships)
 		if(!ship->IsParked() && !ship->IsDisabled() && ship->GetSystem() == system)
 		{
-			conditions["cargo space"] += ship->Attributes().Get("cargo space");
-			conditions["passenger space"] += ship->Attributes().Get("bunks") - ship->RequiredCrew();
+			cargoSpace += ship->Attributes().Get("cargo space");
+			passengerSpace += ship->Attributes().Get("bunks") - ship->RequiredCrew();
 			++conditions["ships: " + ship->Attributes().Category()];
 		}
+	conditions[CARGO_SPACE] = cargoSpace;
+	conditions[PASSENGER_SPACE] = passengerSpace;
 	// If boarding a ship, missions should not consider the space available
 	// in the player's entire fleet. The only fleet parameter offered to a
 	// boarding mission is the fleet composition (e.g. 4 Heavy Warships).
 	if(isBoarding && flagship)
 	{
-		conditions["cargo space"] = flagship->Cargo().Free();
-		conditions["passenger space"] = flagship->Cargo().BunksFree();
+		conditions[CARGO_SPACE] = flagship->Cargo().Free();
+		conditions[PASSENGER_SPACE] = flagship->Cargo().BunksFree();
 	}
 	
-	// Clear any existing flagship system: and planet: conditions. (Note: '!' = ' ' + 1.)
-	clearRange(conditions, "flagship system: ", "flagship system:!");
-	clearRange(conditions, "flagship planet: ", "flagship planet:!");
+	// Clear any existing flagship system: and planet: conditions.
+	conditions.ErasePrefix("flagship system: ");
+	conditions.ErasePrefix("flagship planet: ");
 	
 	// Store conditions for flagship current crew, required crew, and bunks.
 	if(flagship)
 	{
-		conditions["flagship crew"] = flagship->Crew();
-		conditions["flagship required crew"] = flagship->RequiredCrew();
-		conditions["flagship bunks"] = flagship->Attributes().Get("bunks");
+		conditions[FLAGSHIP_CREW] = flagship->Crew();
+		conditions[FLAGSHIP_REQUIRED_CREW] = flagship->RequiredCrew();
+		conditions[FLAGSHIP_BUNKS] = flagship->Attributes().Get("bunks");
 		if(flagship->GetSystem())
 			conditions["flagship system: " + flagship->GetSystem()->Name()] = 1;
 		if(flagship->GetPlanet())
@@ -2580,16 +2630,16 @@ void PlayerInfo::UpdateAutoConditions(bool isBoarding)
 	}
 	else
 	{
-		conditions["flagship crew"] = 0;
-		conditions["flagship required crew"] = 0;
-		conditions["flagship bunks"] = 0;
+		conditions[FLAGSHIP_CREW] = 0;
+		conditions[FLAGSHIP_REQUIRED_CREW] = 0;
+		conditions[FLAGSHIP_BUNKS] = 0;
 	}
 	
 	// Conditions for your fleet's attractiveness to pirates:
 	pair<double, double> factors = RaidFleetFactors();
-	conditions["cargo attractiveness"] = factors.first;
-	conditions["armament deterrence"] = factors.second;
-	conditions["pirate attraction"] = factors.first - factors.second;
+	conditions[CARGO_ATTRACTIVENESS] = factors.first;
+	conditions[ARMAMENT_DETERRENCE] = factors.second;
+	conditions[PIRATE_ATTRACTION] = factors.first - factors.second;
 }
 
 
@@ -2602,22 +2652,22 @@ void PlayerInfo::CreateMissions()
 	// Check for available missions.
 	bool skipJobs = planet && !planet->IsInhabited();
 	bool hasPriorityMissions = false;
-	for(const auto &it : GameData::Missions())
+	// Only consider the missions whose source requirements could match this
+	// planet, rather than checking the conditions of every mission in the game.
+	for(const Mission *mission : GameData::MissionOffers().Landing(planet))
 	{
-		if(it.second.IsAtLocation(Mission::BOARDING) || it.second.IsAtLocation(Mission::ASSISTING))
-			continue;
-		if(skipJobs && it.second.IsAtLocation(Mission::JOB))
+		if(skipJobs && mission->IsAtLocation(Mission::JOB))
 			continue;
 		
-		if(it.second.CanOffer(*this))
+		if(mission->CanOffer(*this))
 		{
 			list<Mission> &missions =
-				it.second.IsAtLocation(Mission::JOB) ? availableJobs : availableMissions;
+				mission->IsAtLocation(Mission::JOB) ? availableJobs : availableMissions;
 			
-			missions.push_back(it.second.Instantiate(*this));
+			missions.push_back(mission->Instantiate(*this));
 			if(missions.back().HasFailed(*this))
 				missions.pop_back();
-			else if(!it.second.IsAtLocation(Mission::JOB))
+			else if(!mission->IsAtLocation(Mission::JOB))
 				hasPriorityMissions |= missions.back().HasPriority();
 		}
 	}
@@ -2763,15 +2813,26 @@ void PlayerInfo::Autosave() const
 		return;
 	
 	string path = filePath.substr(0, filePath.length() - 4) + "~autosave.txt";
-	Save(path);
+	Save(path, false);
 }
 
 
 
-void PlayerInfo::Save(const string &path) const
+// Compose the saved game in memory, then hand it off to be written to disk in
+// the background. Only one save is ever being written at a time.
+void PlayerInfo::Save(const string &path, bool backUp) const
 {
-	DataWriter out(path);
+	DataWriter out(Preferences::Has("Compact saved games") ? DataWriter::Encoding::BINARY : DataWriter::Encoding::TEXT);
+	Save(out);
 	
+	FinishSaving();
+	saveThread = thread(WriteSave, path, out.Contents(), backUp, date.ToString());
+}
+
+
+
+void PlayerInfo::Save(DataWriter &out) const
+{
 	
 	// Basic player information and persistent UI settings:
 	
@@ -2785,6 +2846,19 @@ void PlayerInfo::Save(const string &path) const
 	if(planet && planet->CanUseServices())
 		out.Write("clearance");
 	out.Write("playtime", playTime);
+	// Summarize what the load panel shows about this pilot, so that it does not
+	// need to read the entire file. This must come after the basic information.
+	out.Write("summary");
+	out.BeginChild();
+	{
+		out.Write("credits", accounts.Credits());
+		if(!ships.empty() && ships.front()->GetSprite())
+			out.Write("flagship", ships.front()->Name(), ships.front()->GetSprite()->Name());
+	}
+	out.EndChild();
+	// In a binary save, this lets the summary be read without the string table
+	// for the rest of the file.
+	out.EndSection();
 	// This flag is set if the player must leave the planet immediately upon
 	// entering their ship (i.e. because a mission forced them to take off).
 	if(shouldLaunch)
@@ -2905,18 +2979,19 @@ void PlayerInfo::Save(const string &path) const
 		mission.Save(out, "available mission");
 	
 	// Save any "condition" flags that are set.
-	if(!conditions.empty())
+	if(!conditions.IsEmpty())
 	{
 		out.Write("conditions");
 		out.BeginChild();
 		{
-			for(const auto &it : conditions)
+			for(int id : conditions.Ids())
 			{
 				// If the condition's value is 1, don't bother writing the 1.
-				if(it.second == 1)
-					out.Write(it.first);
-				else if(it.second)
-					out.Write(it.first, it.second);
+				int64_t value = conditions.Get(id);
+				if(value == 1)
+					out.Write(ConditionsStore::Name(id));
+				else if(value)
+					out.Write(ConditionsStore::Name(id), value);
 			}
 		}
 		out.EndChild();
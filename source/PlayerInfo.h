@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Account.h"
 #include "CargoHold.h"
+#include "ConditionsStore.h"
 #include "CoreStartData.h"
 #include "DataNode.h"
 #include "Date.h"
@@ -31,6 +32,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <utility>
 #include <vector>
 
+class DataWriter;
 class Government;
 class Outfit;
 class Planet;
@@ -73,6 +75,9 @@ public:
 	bool LoadRecent();
 	// Save this player (using the Identifier() as the file name).
 	void Save() const;
+	// Saving is done in the background. Wait for any save that is in progress
+	// to be completely written to disk.
+	static void FinishSaving();
 	
 	// Get the root filename used for this player's saved game files. (If there
 	// are multiple pilots with the same name it may have a digit appended.)
@@ -200,8 +205,8 @@ public:
 	
 	// Access the "condition" flags for this player.
 	int64_t GetCondition(const std::string &name) const;
-	std::map<std::string, int64_t> &Conditions();
-	const std::map<std::string, int64_t> &Conditions() const;
+	ConditionsStore &Conditions();
+	const ConditionsStore &Conditions() const;
 	// Set and check the reputation conditions, which missions and events
 	// can use to modify the player's reputation with other governments.
 	void SetReputationConditions();
@@ -282,7 +287,8 @@ private:
 	void CreateMissions();
 	void StepMissions(UI *ui);
 	void Autosave() const;
-	void Save(const std::string &path) const;
+	void Save(const std::string &path, bool backUp) const;
+	void Save(DataWriter &out) const;
 	
 	// Check for and apply any punitive actions from planetary security.
 	void Fine(UI *ui);
@@ -338,7 +344,7 @@ private:
 	// its NPCs to be placed before the player lands, and is then cleared.
 	Mission *activeBoardingMission = nullptr;
 	
-	std::map<std::string, int64_t> conditions;
+	ConditionsStore conditions;
 	
 	std::set<const System *> seen;
 	std::set<const System *> visitedSystems;
@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "text/alignment.hpp"
 #include "Command.h"
+#include "ConditionsStore.h"
 #include "text/Font.h"
 #include "text/FontSet.h"
 #include "text/Format.h"
@@ -50,13 +51,11 @@ namespace {
 	{
 		vector<pair<int64_t, string>> match;
 		
-		auto it = player.Conditions().lower_bound(prefix);
-		for( ; it != player.Conditions().end(); ++it)
+		for(int id : player.Conditions().Ids(prefix))
 		{
-			if(it->first.compare(0, prefix.length(), prefix))
-				break;
-			if(it->second > 0)
-				match.emplace_back(it->second, it->first.substr(prefix.length()) + suffix);
+			int64_t value = player.Conditions().Get(id);
+			if(value > 0)
+				match.emplace_back(value, ConditionsStore::Name(id).substr(prefix.length()) + suffix);
 		}
 		return match;
 	}
@@ -29,6 +29,9 @@ namespace {
 	map<string, bool> settings;
 	int scrollSpeed = 60;
 	
+	const vector<int> TEXTURE_BUDGETS = {0, 256, 512, 1024, 2048};
+	int textureBudget = 0;
+	
 	// Strings for ammo expenditure:
 	const string EXPEND_AMMO = "Escorts expend ammo";
 	const string FRUGAL_ESCORTS = "Escorts use ammo frugally";
@@ -77,6 +80,8 @@ void Preferences::Load()
 			scrollSpeed = node.Value(1);
 		else if(node.Token(0) == "view zoom")
 			zoomIndex = max<int>(0, min<int>(node.Value(1), ZOOMS.size() - 1));
+		else if(node.Token(0) == "texture budget" && node.Size() >= 2)
+			textureBudget = max<int>(0, node.Value(1));
 		else if(node.Token(0) == "vsync")
 			vsyncIndex = max<int>(0, min<int>(node.Value(1), VSYNC_SETTINGS.size() - 1));
 		else
@@ -94,6 +99,7 @@ void Preferences::Save()
 	out.Write("window size", Screen::RawWidth(), Screen::RawHeight());
 	out.Write("zoom", Screen::UserZoom());
 	out.Write("scroll speed", scrollSpeed);
+	out.Write("texture budget", textureBudget);
 	out.Write("view zoom", zoomIndex);
 	out.Write("vsync", vsyncIndex);
 	
@@ -150,6 +156,31 @@ void Preferences::SetScrollSpeed(int speed)
 
 
 
+// Texture memory budget, in megabytes.
+int Preferences::TextureBudget()
+{
+	return textureBudget;
+}
+
+
+
+// Cycle through the texture memory budgets, from no limit to the largest.
+void Preferences::ToggleTextureBudget()
+{
+	auto it = upper_bound(TEXTURE_BUDGETS.begin(), TEXTURE_BUDGETS.end(), textureBudget);
+	textureBudget = (it == TEXTURE_BUDGETS.end()) ? TEXTURE_BUDGETS.front() : *it;
+}
+
+
+
+// Get a description of the texture memory budget.
+string Preferences::TextureBudgetSetting()
+{
+	return textureBudget ? to_string(textureBudget) + " MB" : "unlimited";
+}
+
+
+
 // View zoom.
 double Preferences::ViewZoom()
 {
@@ -42,6 +42,13 @@ public:
 	static int ScrollSpeed();
 	static void SetScrollSpeed(int speed);
 	
+	// The most memory that sprite textures should use, in megabytes, or zero
+	// if there is no limit. Textures of sprites that have not been drawn
+	// recently are unloaded to stay within this budget.
+	static int TextureBudget();
+	static void ToggleTextureBudget();
+	static std::string TextureBudgetSetting();
+	
 	// View zoom.
 	static double ViewZoom();
 	static bool ZoomViewIn();
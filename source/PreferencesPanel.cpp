@@ -55,6 +55,7 @@ namespace {
 	const string FRUGAL_ESCORTS = "Escorts use ammo frugally";
 	const string REACTIVATE_HELP = "Reactivate first-time help";
 	const string SCROLL_SPEED = "Scroll speed";
+	const string TEXTURE_BUDGET = "Texture memory";
 	const string FIGHTER_REPAIR = "Repair fighters in";
 	const string SHIP_OUTLINES = "Ship outlines in shops";
 }
@@ -187,6 +188,8 @@ bool PreferencesPanel::Click(int x, int y, int clicks)
 				for(const auto &it : GameData::HelpTemplates())
 					Preferences::Set("help: " + it.first, false);
 			}
+			else if(zone.Value() == TEXTURE_BUDGET)
+				Preferences::ToggleTextureBudget();
 			else if(zone.Value() == SCROLL_SPEED)
 			{
 				// Toggle between three different speeds.
@@ -454,6 +457,8 @@ void PreferencesPanel::DrawSettings()
 		"Draw starfield",
 		"Show hyperspace flash",
 		SHIP_OUTLINES,
+		TEXTURE_BUDGET,
+		"Compact saved games",
 		"",
 		"Other",
 		"Clickable radar display",
@@ -564,6 +569,11 @@ void PreferencesPanel::DrawSettings()
 			isOn = true;
 			text = to_string(Preferences::ScrollSpeed());
 		}
+		else if(setting == TEXTURE_BUDGET)
+		{
+			isOn = true;
+			text = Preferences::TextureBudgetSetting();
+		}
 		else
 			text = isOn ? "on" : "off";
 		
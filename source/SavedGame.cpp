@@ -12,14 +12,24 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "SavedGame.h"
 
+#include "BinaryData.h"
 #include "DataFile.h"
 #include "DataNode.h"
 #include "Date.h"
+#include "File.h"
+#include "Files.h"
 #include "text/Format.h"
 #include "SpriteSet.h"
 
+#include <cstdio>
+#include <sstream>
+
 using namespace std;
 
+namespace {
+	const string SUMMARY = "\nsummary";
+}
+
 
 
 SavedGame::SavedGame(const string &path)
@@ -29,16 +39,90 @@ SavedGame::SavedGame(const string &path)
 
 
 
+// Read the beginning of the given saved game, up to the end of its summary.
+string SavedGame::ReadHeader(const string &path)
+{
+	string data;
+	File file(path);
+	if(!file)
+		return data;
+	
+	static const size_t BLOCK = 4096;
+	size_t summary = string::npos;
+	while(true)
+	{
+		size_t size = data.size();
+		data.resize(size + BLOCK);
+		data.resize(size + fread(&data[size], 1, BLOCK, file));
+		bool atEnd = (data.size() < size + BLOCK);
+		
+		// Binary saves have everything up to the summary in their first
+		// section, which says how long it is.
+		if(!size && BinaryData::IsBinary(data))
+		{
+			size_t length = BinaryData::FirstSectionLength(data);
+			if(length <= data.size())
+				data.resize(length);
+			else if(!atEnd)
+			{
+				size_t read = data.size();
+				data.resize(length);
+				data.resize(read + fread(&data[read], 1, length - read, file));
+			}
+			return data;
+		}
+		
+		// Look for the summary, allowing for it to be split between blocks.
+		if(summary == string::npos)
+		{
+			size_t start = (size < SUMMARY.length() ? 0 : size - SUMMARY.length());
+			for(summary = data.find(SUMMARY, start); summary != string::npos; summary = data.find(SUMMARY, summary + 1))
+			{
+				size_t next = summary + SUMMARY.length();
+				if(next < data.length() && (data[next] == '\n' || data[next] == '\r'))
+					break;
+			}
+		}
+		// The summary ends at the first line after it that is not indented.
+		if(summary != string::npos)
+			for(size_t pos = data.find('\n', summary + 1); pos != string::npos && pos + 1 < data.length();
+					pos = data.find('\n', pos + 1))
+				if(static_cast<unsigned char>(data[pos + 1]) > ' ')
+					return data.substr(0, pos + 1);
+		
+		if(atEnd)
+			return data;
+	}
+}
+
+
+
 void SavedGame::Load(const string &path)
 {
 	Clear();
-	DataFile file(path);
+	istringstream in(ReadHeader(path));
+	DataFile file(in);
 	if(file.begin() != file.end())
 		this->path = path;
 	
 	for(const DataNode &node : file)
 	{
-		if(node.Token(0) == "pilot" && node.Size() >= 3)
+		if(node.Token(0) == "summary")
+		{
+			for(const DataNode &child : node)
+			{
+				if(child.Token(0) == "credits" && child.Size() >= 2)
+					credits = Format::Credits(child.Value(1));
+				else if(child.Token(0) == "flagship" && child.Size() >= 3)
+				{
+					shipName = child.Token(1);
+					shipSprite = SpriteSet::Get(child.Token(2));
+				}
+			}
+			// Everything that is needed is in the summary.
+			break;
+		}
+		else if(node.Token(0) == "pilot" && node.Size() >= 3)
 			name = node.Token(1) + " " + node.Token(2);
 		else if(node.Token(0) == "date" && node.Size() >= 4)
 			date = Date(node.Value(1), node.Value(2), node.Value(3)).ToString();
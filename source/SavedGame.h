@@ -23,12 +23,17 @@ class Sprite;
 // information necessary from the file to display it in the "Load Game" panel,
 // without doing all the complicated parsing that PlayerInfo does. This is so
 // that we only need to have one PlayerInfo instance, and there does not need
-// to be logic for copying one PlayerInfo into another.
+// to be logic for copying one PlayerInfo into another. Saved games begin with
+// a short summary, so only that part of the file needs to be read.
 class SavedGame {
 public:
 	SavedGame() = default;
 	explicit SavedGame(const std::string &path);
 	
+	// Read the beginning of the given saved game, up to the end of its summary.
+	// Saves from older versions have no summary, so all of the file is read.
+	static std::string ReadHeader(const std::string &path);
+	
 	void Load(const std::string &path);
 	const std::string &Path() const;
 	bool IsLoaded() const;
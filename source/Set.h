@@ -13,49 +13,184 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef SET_H_
 #define SET_H_
 
+#include "DataNode.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 
 
 // Template representing a set of named objects of a given type, where you can
 // query it for a pointer to any object and it will return one, whether or not that
 // object has been loaded yet. (This allows cyclic pointers.)
+// Objects may also be "deferred," meaning that their definitions are kept as
+// DataNodes and only loaded the first time the object is requested by name or
+// the set is iterated over. The objects are stored in name order, and also
+// indexed by a hash of their names so that lookups need not walk the tree.
 template<class Type>
 class Set {
 public:
+	Set() = default;
+	// The index refers to this set's own storage, so it must be rebuilt when
+	// the set is copied.
+	Set(const Set &other);
+	Set &operator=(const Set &other);
+	
 	// Allow non-const access to the owner of this set; it can hand off only
 	// const references to avoid anyone else modifying the objects.
-	Type *Get(const std::string &name) { return &data[name]; }
-	const Type *Get(const std::string &name) const { return &data[name]; }
+	Type *Get(const std::string &name) { return Get(name.data(), name.size()); }
+	const Type *Get(const std::string &name) const { return Get(name.data(), name.size()); }
+	// Looking up a name given as a C string does not create a temporary string
+	// unless the object does not exist yet.
+	Type *Get(const char *name) { return Get(name, std::strlen(name)); }
+	const Type *Get(const char *name) const { return Get(name, std::strlen(name)); }
 	// If an item already exists in this set, get it. Otherwise, return a null
 	// pointer rather than creating the item.
-	const Type *Find(const std::string &name) const;
+	const Type *Find(const std::string &name) const { return Find(name.data(), name.size()); }
+	const Type *Find(const char *name) const { return Find(name, std::strlen(name)); }
+	
+	bool Has(const std::string &name) const { return index.count(Key{name.data(), name.size()}) || deferred.count(name); }
 	
-	bool Has(const std::string &name) const { return data.count(name); }
+	// Remember a definition of the given object without loading it yet. All of
+	// an object's definitions are applied, in the order they were given, when
+	// it is first requested. If a pointer to the object has already been handed
+	// out, the definition is instead loaded immediately.
+	void Defer(const std::string &name, const DataNode &node);
+	// Check whether the given object has definitions that are not loaded yet.
+	bool IsDeferred(const std::string &name) const { return deferred.count(name); }
+	// Access the definitions that have not been loaded yet, and the objects that
+	// have, without forcing any deferred objects to be loaded. Objects must not
+	// be added to or removed from the map of loaded objects directly.
+	const std::map<std::string, std::vector<DataNode>> &Deferred() const { return deferred; }
+	std::map<std::string, Type> &Loaded() { return data; }
+	// Load every object that has definitions that are not loaded yet.
+	void LoadAll() const;
 	
-	typename std::map<std::string, Type>::iterator begin() { return data.begin(); }
-	typename std::map<std::string, Type>::const_iterator begin() const { return data.begin(); }
+	typename std::map<std::string, Type>::iterator begin() { LoadAll(); return data.begin(); }
+	typename std::map<std::string, Type>::const_iterator begin() const { LoadAll(); return data.begin(); }
 	typename std::map<std::string, Type>::iterator end() { return data.end(); }
 	typename std::map<std::string, Type>::const_iterator end() const { return data.end(); }
 	
-	int size() const { return data.size(); }
+	int size() const { return data.size() + deferred.size(); }
+	// Discard everything that has been loaded or deferred for the given object,
+	// so that it can be loaded again. Pointers to it remain valid.
+	void Discard(const std::string &name);
 	// Remove any objects in this set that are not in the given set, and for
 	// those that are in the given set, revert to their contents.
 	void Revert(const Set<Type> &other);
 	
 	
+private:
+	// A reference to a name, which is either a key of the data map or the
+	// string that is being looked up.
+	struct Key {
+		const char *str;
+		size_t length;
+		
+		bool operator==(const Key &other) const { return length == other.length && !std::memcmp(str, other.str, length); }
+	};
+	struct KeyHash {
+		size_t operator()(const Key &key) const;
+	};
+	
+	
+private:
+	Type *Get(const char *name, size_t length) const;
+	const Type *Find(const char *name, size_t length) const;
+	// Get the given object, creating it and applying any deferred definitions
+	// of it if this is the first time it has been requested.
+	Type *Materialize(const std::string &name) const;
+	void Reindex();
+	static void LoadDeferred(Type &object, const DataNode &node) { object.Load(node); }
+	
+	
 private:
 	mutable std::map<std::string, Type> data;
+	// Index of the objects in the data map. The map's nodes never move, so the
+	// keys can refer to the map's own strings.
+	mutable std::unordered_map<Key, Type *, KeyHash> index;
+	// Definitions of objects that have not been requested yet. A name is never
+	// in both this map and the map of loaded objects.
+	mutable std::map<std::string, std::vector<DataNode>> deferred;
+	// This is only set if Defer() is used, so that sets of objects that are
+	// loaded differently need not provide a Load(const DataNode &) function.
+	void (*loader)(Type &, const DataNode &) = nullptr;
 };
 
 
 
 template <class Type>
-const Type *Set<Type>::Find(const std::string &name) const
+Set<Type>::Set(const Set &other)
+	: data(other.data), deferred(other.deferred), loader(other.loader)
 {
-	auto it = data.find(name);
-	return (it == data.end() ? nullptr : &it->second);
+	Reindex();
+}
+
+
+
+template <class Type>
+Set<Type> &Set<Type>::operator=(const Set &other)
+{
+	data = other.data;
+	deferred = other.deferred;
+	loader = other.loader;
+	Reindex();
+	return *this;
+}
+
+
+
+template <class Type>
+Type *Set<Type>::Get(const char *name, size_t length) const
+{
+	auto it = index.find(Key{name, length});
+	return (it == index.end() ? Materialize(std::string(name, length)) : it->second);
+}
+
+
+
+template <class Type>
+const Type *Set<Type>::Find(const char *name, size_t length) const
+{
+	auto it = index.find(Key{name, length});
+	if(it != index.end())
+		return it->second;
+	if(deferred.empty())
+		return nullptr;
+	
+	const std::string key(name, length);
+	return deferred.count(key) ? Materialize(key) : nullptr;
+}
+
+
+
+template <class Type>
+void Set<Type>::Defer(const std::string &name, const DataNode &node)
+{
+	loader = &LoadDeferred;
+	auto it = index.find(Key{name.data(), name.size()});
+	if(it != index.end())
+		loader(*it->second, node);
+	else
+		deferred[name].push_back(node);
+}
+
+
+
+template <class Type>
+void Set<Type>::Discard(const std::string &name)
+{
+	deferred.erase(name);
+	auto it = index.find(Key{name.data(), name.size()});
+	if(it != index.end())
+		*it->second = Type();
 }
 
 
@@ -63,13 +198,19 @@ const Type *Set<Type>::Find(const std::string &name) const
 template <class Type>
 void Set<Type>::Revert(const Set<Type> &other)
 {
+	LoadAll();
+	other.LoadAll();
+	
 	auto it = data.begin();
 	auto oit = other.data.begin();
 	
 	while(it != data.end())
 	{
 		if(oit == other.data.end() || it->first < oit->first)
+		{
+			index.erase(Key{it->first.data(), it->first.size()});
 			it = data.erase(it);
+		}
 		else if(it->first == oit->first)
 		{
 			// If this is an entry that is in the set we are reverting to, copy
@@ -86,4 +227,69 @@ void Set<Type>::Revert(const Set<Type> &other)
 
 
 
+template <class Type>
+Type *Set<Type>::Materialize(const std::string &name) const
+{
+	auto it = data.find(name);
+	if(it != data.end())
+		return &it->second;
+	
+	it = data.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple()).first;
+	Type *object = &it->second;
+	index.emplace(Key{it->first.data(), it->first.size()}, object);
+	auto dit = deferred.find(name);
+	if(dit != deferred.end())
+	{
+		// Remove the definitions before loading them, because loading this
+		// object may request other deferred objects, including this one.
+		std::vector<DataNode> nodes = std::move(dit->second);
+		deferred.erase(dit);
+		for(const DataNode &node : nodes)
+			loader(*object, node);
+	}
+	return object;
+}
+
+
+
+template <class Type>
+void Set<Type>::LoadAll() const
+{
+	while(!deferred.empty())
+	{
+		// Copy the name, since loading the object removes it from the map.
+		const std::string name = deferred.begin()->first;
+		Materialize(name);
+	}
+}
+
+
+
+template <class Type>
+void Set<Type>::Reindex()
+{
+	index.clear();
+	index.reserve(data.size());
+	for(auto &it : data)
+		index.emplace(Key{it.first.data(), it.first.size()}, &it.second);
+}
+
+
+
+// Hash the name using 64-bit FNV-1a, which is fast for the short names that
+// objects typically have.
+template <class Type>
+size_t Set<Type>::KeyHash::operator()(const Key &key) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for(size_t i = 0; i < key.length; ++i)
+	{
+		hash ^= static_cast<unsigned char>(key.str[i]);
+		hash *= 1099511628211ULL;
+	}
+	return static_cast<size_t>(hash);
+}
+
+
+
 #endif
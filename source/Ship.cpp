@@ -2294,8 +2294,9 @@ int Ship::Scan()
 	doScan(outfitScan, outfitSpeed, outfitDistance, ShipEvent::SCAN_OUTFITS);
 	
 	// Play the scanning sound if the actor or the target is the player's ship.
+	static const Sound *scanSound = Audio::Get("scan");
 	if(isYours || (target->isYours && activeScanning))
-		Audio::Play(Audio::Get("scan"), Position());
+		Audio::Play(scanSound, Position());
 	
 	if(startedScanning && isYours)
 	{
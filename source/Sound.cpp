@@ -21,18 +21,19 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <OpenAL/al.h>
 #endif
 
-#include <cstdio>
-#include <vector>
+#include <cstdint>
+#include <string>
 
 using namespace std;
 
 namespace {
-	// Read a WAV header, and return the size of the data, in bytes. If the file
-	// is an unsupported format (anything but little-endian 16-bit PCM at 44100 HZ),
-	// this will return 0.
-	uint32_t ReadHeader(File &in, uint32_t &frequency);
-	uint32_t Read4(File &in);
-	uint16_t Read2(File &in);
+	// Read a WAV header, and return the size of the data, in bytes. The given
+	// offset is moved to the start of the data. If the file is an unsupported
+	// format (anything but little-endian 16-bit PCM at 44100 HZ), this will
+	// return 0.
+	uint32_t ReadHeader(const string &in, size_t &offset, uint32_t &frequency);
+	uint32_t Read4(const string &in, size_t &offset);
+	uint16_t Read2(const string &in, size_t &offset);
 }
 
 
@@ -45,21 +46,21 @@ bool Sound::Load(const string &path, const string &name)
 	
 	isLooped = path[path.length() - 5] == '~';
 	
+	// Read the whole file at once, rather than a few bytes at a time.
 	File in(path);
 	if(!in)
 		return false;
-	uint32_t frequency = 0;
-	uint32_t bytes = ReadHeader(in, frequency);
-	if(!bytes)
-		return false;
+	string data = Files::Read(in);
 	
-	vector<char> data(bytes);
-	if(fread(&data[0], 1, bytes, in) != bytes)
+	size_t offset = 0;
+	uint32_t frequency = 0;
+	uint32_t bytes = ReadHeader(data, offset, frequency);
+	if(!bytes || bytes > data.size() - offset)
 		return false;
 	
 	if(!buffer)
 		alGenBuffers(1, &buffer);
-	alBufferData(buffer, AL_FORMAT_MONO16, &data.front(), bytes, frequency);
+	alBufferData(buffer, AL_FORMAT_MONO16, &data[offset], bytes, frequency);
 	
 	return true;
 }
@@ -88,26 +89,28 @@ bool Sound::IsLooping() const
 
 
 namespace {
-	// Read a WAV header, and return the size of the data, in bytes. If the file
-	// is an unsupported format (anything but little-endian 16-bit PCM at 44100 HZ),
-	// this will return 0.
-	uint32_t ReadHeader(File &in, uint32_t &frequency)
+	// Read a WAV header, and return the size of the data, in bytes. The given
+	// offset is moved to the start of the data. If the file is an unsupported
+	// format (anything but little-endian 16-bit PCM at 44100 HZ), this will
+	// return 0.
+	uint32_t ReadHeader(const string &in, size_t &offset, uint32_t &frequency)
 	{
-		uint32_t chunkID = Read4(in);
+		uint32_t chunkID = Read4(in, offset);
 		if(chunkID != 0x46464952) // "RIFF" in big endian.
 			return 0;
 		
 		// Ignore the "chunk size".
-		Read4(in);
-		uint32_t format = Read4(in);
+		Read4(in, offset);
+		uint32_t format = Read4(in, offset);
 		if(format != 0x45564157) // "WAVE"
 			return 0;
 		
 		bool foundHeader = false;
-		while(true)
+		// Stop if the end of the file is reached without finding the data.
+		while(offset < in.size())
 		{
-			uint32_t subchunkID = Read4(in);
-			uint32_t subchunkSize = Read4(in);
+			uint32_t subchunkID = Read4(in, offset);
+			uint32_t subchunkSize = Read4(in, offset);
 			
 			if(subchunkID == 0x20746d66) // "fmt "
 			{
@@ -115,16 +118,15 @@ namespace {
 				if(subchunkSize < 16)
 					return 0;
 				
-				uint16_t audioFormat = Read2(in);
-				uint16_t numChannels = Read2(in);
-				frequency = Read4(in);
-				uint32_t byteRate = Read4(in);
-				uint32_t blockAlign = Read2(in);
-				uint32_t bitsPerSample = Read2(in);
+				uint16_t audioFormat = Read2(in, offset);
+				uint16_t numChannels = Read2(in, offset);
+				frequency = Read4(in, offset);
+				uint32_t byteRate = Read4(in, offset);
+				uint32_t blockAlign = Read2(in, offset);
+				uint32_t bitsPerSample = Read2(in, offset);
 				
 				// Skip any further bytes in this chunk.
-				if(subchunkSize > 16)
-					fseek(in, subchunkSize - 16, SEEK_CUR);
+				offset += subchunkSize - 16;
 				
 				if(audioFormat != 1)
 					return 0;
@@ -144,33 +146,38 @@ namespace {
 				return subchunkSize;
 			}
 			else
-				fseek(in, subchunkSize, SEEK_CUR);
+				offset += subchunkSize;
 		}
+		return 0;
 	}
 	
 	
 	
-	uint32_t Read4(File &in)
+	uint32_t Read4(const string &in, size_t &offset)
 	{
-		unsigned char data[4];
-		if(fread(data, 1, 4, in) != 4)
+		if(in.size() < 4 || offset > in.size() - 4)
+		{
+			offset = in.size();
 			return 0;
+		}
 		uint32_t result = 0;
 		for(int i = 0; i < 4; ++i)
-			result |= static_cast<uint32_t>(data[i]) << (i * 8);
+			result |= static_cast<uint32_t>(static_cast<unsigned char>(in[offset++])) << (i * 8);
 		return result;
 	}
 	
 	
 	
-	uint16_t Read2(File &in)
+	uint16_t Read2(const string &in, size_t &offset)
 	{
-		unsigned char data[2];
-		if(fread(data, 1, 2, in) != 2)
+		if(in.size() < 2 || offset > in.size() - 2)
+		{
+			offset = in.size();
 			return 0;
+		}
 		uint16_t result = 0;
 		for(int i = 0; i < 2; ++i)
-			result |= static_cast<uint16_t>(data[i]) << (i * 8);
+			result |= static_cast<uint16_t>(static_cast<unsigned char>(in[offset++])) << (i * 8);
 		return result;
 	}
 }
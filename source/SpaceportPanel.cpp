@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "text/alignment.hpp"
 #include "Color.h"
+#include "ConditionsStore.h"
 #include "text/FontSet.h"
 #include "GameData.h"
 #include "Interface.h"
@@ -112,7 +113,7 @@ const News *SpaceportPanel::PickNews() const
 {
 	vector<const News *> matches;
 	const Planet *planet = player.GetPlanet();
-	const map<string, int64_t> &conditions = player.Conditions();
+	const ConditionsStore &conditions = player.Conditions();
 	for(const auto &it : GameData::SpaceportNews())
 		if(!it.second.IsEmpty() && it.second.Matches(planet, conditions))
 			matches.push_back(&it.second);
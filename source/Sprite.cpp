@@ -20,13 +20,43 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <SDL2/SDL.h>
 
 #include <algorithm>
+#include <atomic>
 
 using namespace std;
 
+namespace {
+	// Keep track of the total memory used by all sprites' textures, and of
+	// the current frame, so that the sprites that have not been drawn recently
+	// can be evicted if that memory exceeds the player's budget.
+	size_t totalMemory = 0;
+	atomic<int> frame(0);
+	// Sprites that were drawn before they were loaded, so they can be moved to
+	// the front of the loading queue.
+	vector<const Sprite *> drawnBeforeLoading;
+	
+	// This texture is drawn in place of a sprite that was evicted or has not
+	// been loaded yet, until that sprite is uploaded. It is a single transparent
+	// pixel, created the first time it is needed.
+	uint32_t placeholder = 0;
+	
+	uint32_t Placeholder()
+	{
+		if(!placeholder)
+		{
+			const uint32_t pixel = 0;
+			glGenTextures(1, &placeholder);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, placeholder);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixel);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		}
+		return placeholder;
+	}
+}
+
 
 
 Sprite::Sprite(const string &name)
-	: name(name)
+	: name(name), lastDrawn(0)
 {
 }
 
@@ -46,8 +76,10 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 	if(!buffer.Pixels())
 		return;
 	
-	// If this is the 1x image, its dimensions determine the sprite's size.
-	if(!is2x)
+	// If this is the 1x image, its dimensions determine the sprite's size. A
+	// sprite that is uploaded again after being evicted keeps its dimensions,
+	// since other threads may be reading them.
+	if(!is2x && !isEvicted)
 	{
 		width = buffer.Width();
 		height = buffer.Height();
@@ -76,6 +108,16 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 	// Unbind the texture.
 	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 	
+	totalMemory -= memory[is2x];
+	memory[is2x] = sizeof(uint32_t) * buffer.Width() * buffer.Height() * buffer.Frames();
+	totalMemory += memory[is2x];
+	isEvicted = false;
+	
+	// Small sprites that are drawn in batches are also copied into an atlas.
+	// The atlas keeps its copy when the sprite is evicted.
+	if(!atlas[is2x] && TextureAtlas::ShouldPack(name, buffer))
+		atlas[is2x] = TextureAtlas::Add(buffer, regions[is2x]);
+	
 	// Free the ImageBuffer memory.
 	buffer.Clear();
 }
@@ -86,7 +128,10 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 // vector will be cleared.
 void Sprite::AddMasks(vector<Mask> &masks)
 {
-	this->masks.swap(masks);
+	// A sprite that is loaded again after being evicted keeps its masks, since
+	// they may be in use for collision detection in another thread.
+	if(this->masks.empty())
+		this->masks.swap(masks);
 	masks.clear();
 }
 
@@ -95,8 +140,16 @@ void Sprite::AddMasks(vector<Mask> &masks)
 // Free up all textures loaded for this sprite.
 void Sprite::Unload()
 {
-	glDeleteTextures(2, texture);
-	texture[0] = texture[1] = 0;
+	Evict();
+	isEvicted = false;
+	wasDrawnBeforeLoading = false;
+	for(int i = 0; i < 2; ++i)
+	{
+		if(atlas[i])
+			TextureAtlas::Remove(atlas[i], regions[i]);
+		atlas[i] = 0;
+		regions[i].clear();
+	}
 	
 	masks.clear();
 	width = 0.f;
@@ -106,6 +159,83 @@ void Sprite::Unload()
 
 
 
+// Free up this sprite's textures to save memory, but keep its dimensions
+// and masks.
+void Sprite::Evict()
+{
+	glDeleteTextures(2, texture);
+	texture[0] = texture[1] = 0;
+	
+	totalMemory -= memory[0] + memory[1];
+	memory[0] = memory[1] = 0;
+	isEvicted = true;
+}
+
+
+
+// Get the amount of texture memory this sprite's own textures use.
+size_t Sprite::TextureMemory() const
+{
+	return memory[0] + memory[1];
+}
+
+
+
+// Check if this sprite's textures were evicted.
+bool Sprite::IsEvicted() const
+{
+	return isEvicted;
+}
+
+
+
+// Get the last frame in which this sprite was drawn.
+int Sprite::LastDrawn() const
+{
+	return lastDrawn.load(memory_order_relaxed);
+}
+
+
+
+// Treat this sprite as if it had been drawn in the current frame.
+void Sprite::MarkUsed() const
+{
+	lastDrawn.store(frame.load(memory_order_relaxed), memory_order_relaxed);
+	if(!texture[0] && !isEvicted && !wasDrawnBeforeLoading)
+	{
+		wasDrawnBeforeLoading = true;
+		drawnBeforeLoading.push_back(this);
+	}
+}
+
+
+
+// Get every sprite that was drawn before any of its textures were loaded.
+vector<const Sprite *> Sprite::DrawnBeforeLoading()
+{
+	vector<const Sprite *> result;
+	result.swap(drawnBeforeLoading);
+	return result;
+}
+
+
+
+// Get the texture memory used by all sprites.
+size_t Sprite::TotalTextureMemory()
+{
+	return totalMemory;
+}
+
+
+
+// Advance the frame count, returning the new frame number.
+int Sprite::NextFrame()
+{
+	return ++frame;
+}
+
+
+
 // Get the width, in pixels, of the 1x image.
 float Sprite::Width() const
 {
@@ -150,11 +280,42 @@ uint32_t Sprite::Texture() const
 // Get the index of the texture for the given high DPI mode.
 uint32_t Sprite::Texture(bool isHighDPI) const
 {
+	MarkUsed();
+	if(!texture[0])
+		return Placeholder();
+	
 	return (isHighDPI && texture[1]) ? texture[1] : texture[0];
 }
 
 
 
+// Get the texture to use when drawing this sprite in a batch.
+uint32_t Sprite::BatchTexture(bool isHighDPI) const
+{
+	int i = (isHighDPI && texture[1]);
+	if(atlas[i])
+		return atlas[i];
+	
+	MarkUsed();
+	return texture[i] ? texture[i] : Placeholder();
+}
+
+
+
+// Get where the given frame is within the batch texture.
+TextureAtlas::Region Sprite::BatchRegion(int frame, bool isHighDPI) const
+{
+	int i = (isHighDPI && texture[1]);
+	if(atlas[i] && frame >= 0 && static_cast<size_t>(frame) < regions[i].size())
+		return regions[i][frame];
+	
+	TextureAtlas::Region region;
+	region.layer = frame;
+	return region;
+}
+
+
+
 // Get the collision mask for the given frame of the animation.
 const Mask &Sprite::GetMask(int frame) const
 {
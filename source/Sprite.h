@@ -15,7 +15,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Mask.h"
 #include "Point.h"
+#include "TextureAtlas.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -38,11 +41,33 @@ public:
 	
 	// Upload the given frames. The given buffer will be cleared afterwards.
 	void AddFrames(ImageBuffer &buffer, bool is2x);
-	// Move the given masks into this sprite's internal storage. The given
-	// vector will be cleared.
+	// Move the given masks into this sprite's internal storage, unless it
+	// already has masks. The given vector will be cleared.
 	void AddMasks(std::vector<Mask> &masks);
 	// Free up all textures loaded for this sprite.
 	void Unload();
+	// Free up this sprite's textures to save memory, but keep its dimensions
+	// and masks. It is drawn as a transparent placeholder until its textures
+	// are uploaded again.
+	void Evict();
+	
+	// Get the amount of texture memory this sprite's own textures use.
+	size_t TextureMemory() const;
+	// Check if this sprite's textures were evicted, and the last frame in
+	// which this sprite was drawn.
+	bool IsEvicted() const;
+	int LastDrawn() const;
+	// Treat this sprite as if it had been drawn in the current frame, so that
+	// it will be loaded soon if it has not been loaded yet or was evicted, and
+	// will not be evicted soon.
+	void MarkUsed() const;
+	// Get every sprite that was drawn before any of its textures were loaded,
+	// since the last time this was called.
+	static std::vector<const Sprite *> DrawnBeforeLoading();
+	// Get the texture memory used by all sprites, and advance the frame count
+	// used to keep track of when each sprite was last drawn.
+	static size_t TotalTextureMemory();
+	static int NextFrame();
 	
 	// Image dimensions, in pixels.
 	float Width() const;
@@ -56,9 +81,15 @@ public:
 	Point Center() const;
 	
 	// Get the texture index, either looking it up based on the Screen's HighDPI
-	// setting or specifying it manually.
+	// setting or specifying it manually. Textures are uploaded and evicted in
+	// the OpenGL thread, so these must only be called from that thread.
 	uint32_t Texture() const;
 	uint32_t Texture(bool isHighDPI) const;
+	// Get the texture to use when drawing this sprite in a batch, and where
+	// the given frame is within that texture. Small sprites may be packed into
+	// a shared texture atlas, so that many of them can be drawn together.
+	uint32_t BatchTexture(bool isHighDPI) const;
+	TextureAtlas::Region BatchRegion(int frame, bool isHighDPI) const;
 	// Get the collision mask for the given frame of the animation.
 	const Mask &GetMask(int frame = 0) const;
 	
@@ -67,6 +98,14 @@ private:
 	std::string name;
 	
 	uint32_t texture[2] = {0, 0};
+	// If this sprite is also packed into a texture atlas, the atlas texture
+	// and the location of each frame in it.
+	uint32_t atlas[2] = {0, 0};
+	std::vector<TextureAtlas::Region> regions[2];
+	size_t memory[2] = {0, 0};
+	bool isEvicted = false;
+	mutable bool wasDrawnBeforeLoading = false;
+	mutable std::atomic<int> lastDrawn;
 	std::vector<Mask> masks;
 	
 	float width = 0.f;
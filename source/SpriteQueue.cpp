@@ -17,6 +17,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Mask.h"
 #include "Sprite.h"
 #include "SpriteSet.h"
+#include "Timeline.h"
 
 #include <algorithm>
 #include <functional>
@@ -38,19 +39,13 @@ SpriteQueue::SpriteQueue()
 // Destructor, which waits for all worker threads to wrap up.
 SpriteQueue::~SpriteQueue()
 {
-	{
-		lock_guard<mutex> lock(readMutex);
-		added = -1;
-	}
-	readCondition.notify_all();
-	for(thread &t : threads)
-		t.join();
+	Stop();
 }
 
 
 
 // Add a sprite to load.
-void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
+void SpriteQueue::Add(const shared_ptr<ImageSet> &images, Priority priority)
 {
 	{
 		lock_guard<mutex> lock(readMutex);
@@ -58,14 +53,34 @@ void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
 		if(added < 0)
 			return;
 		
-		toRead.push(images);
+		toRead[static_cast<int>(priority)].emplace_back(images, priority);
 		++added;
+		addedBackground += (priority == Priority::BACKGROUND);
 	}
 	readCondition.notify_one();
 }
 
 
 
+// If the given sprite has not been read from disk yet, read it next.
+void SpriteQueue::Prioritize(const string &name)
+{
+	lock_guard<mutex> lock(readMutex);
+	for(auto &queue : toRead)
+		for(auto it = queue.begin(); it != queue.end(); ++it)
+			if(it->first->Name() == name)
+			{
+				// The sprite still counts toward the progress of the priority
+				// that it was added with.
+				auto entry = *it;
+				queue.erase(it);
+				toRead[0].push_front(entry);
+				return;
+			}
+}
+
+
+
 // Unload the texture for the given sprite (to free up memory).
 void SpriteQueue::Unload(const string &name)
 {
@@ -75,6 +90,16 @@ void SpriteQueue::Unload(const string &name)
 
 
 
+// Unload the texture for the given sprite, but keep its dimensions and
+// collision masks so that it can still be used until it is loaded again.
+void SpriteQueue::Evict(const string &name)
+{
+	unique_lock<mutex> lock(loadMutex);
+	toEvict.push(name);
+}
+
+
+
 // Find out our percent completion.
 double SpriteQueue::Progress()
 {
@@ -84,7 +109,17 @@ double SpriteQueue::Progress()
 
 
 
-// Finish loading.
+// Check if every sprite, including the background sprites, has been loaded.
+bool SpriteQueue::IsFinished()
+{
+	unique_lock<mutex> lock(loadMutex);
+	unique_lock<mutex> readLock(readMutex);
+	return added <= 0 || added == completed;
+}
+
+
+
+// Finish loading everything but the background sprites.
 void SpriteQueue::Finish()
 {
 	// Loop until done loading.
@@ -92,18 +127,37 @@ void SpriteQueue::Finish()
 	{
 		unique_lock<mutex> lock(loadMutex);
 		
-		// Load whatever is already queued up for loading.
+		// Load whatever is already queued up for loading. The background
+		// sprites are loaded after all the others, so once the others are done
+		// there is no need to wait for them.
 		if(DoLoad(lock) == 1.)
 			break;
 		
 		// We still have sprites to upload, but none of them have been read from
 		// disk yet. Wait until one arrives.
-		loadCondition.wait(lock);
+		if(toLoad.empty())
+			loadCondition.wait(lock);
 	}
 }
 
 
 
+// Stop the worker threads, once they finish reading whatever sprites they
+// are working on.
+void SpriteQueue::Stop()
+{
+	{
+		lock_guard<mutex> lock(readMutex);
+		added = -1;
+	}
+	readCondition.notify_all();
+	for(thread &t : threads)
+		if(t.joinable())
+			t.join();
+}
+
+
+
 // Thread entry point.
 void SpriteQueue::operator()()
 {
@@ -116,12 +170,15 @@ void SpriteQueue::operator()()
 			// "added" to -1.
 			if(added < 0)
 				return;
-			if(toRead.empty())
+			auto queue = find_if(begin(toRead), end(toRead),
+				[](const deque<pair<shared_ptr<ImageSet>, Priority>> &it) { return !it.empty(); });
+			if(queue == end(toRead))
 				break;
 			
 			// Extract the one item we should work on reading right now.
-			shared_ptr<ImageSet> imageSet = toRead.front();
-			toRead.pop();
+			pair<shared_ptr<ImageSet>, Priority> entry = queue->front();
+			queue->pop_front();
+			const shared_ptr<ImageSet> &imageSet = entry.first;
 			
 			// It's now safe to add to the lists.
 			lock.unlock();
@@ -129,12 +186,18 @@ void SpriteQueue::operator()()
 			// Load the sprite.
 			// TODO: investigate catching exceptions from Load() (e.g. bad_alloc), to enable
 			// the UI thread to display a message prior to terminating the process.
-			imageSet->Load();
+			{
+				// These threads start before the timeline does, so they are
+				// named when they are given work instead.
+				Timeline::NameThread("sprite worker");
+				Timeline::Scope scope("Decode sprite", imageSet->Name());
+				imageSet->Load();
+			}
 			
 			{
 				// The texture must be uploaded to OpenGL in the main thread.
 				unique_lock<mutex> lock(loadMutex);
-				toLoad.push(imageSet);
+				toLoad.push(entry);
 			}
 			loadCondition.notify_one();
 			
@@ -158,27 +221,44 @@ double SpriteQueue::DoLoad(unique_lock<mutex> &lock)
 		sprite->Unload();
 		lock.lock();
 	}
+	while(!toEvict.empty())
+	{
+		Sprite *sprite = SpriteSet::Modify(toEvict.front());
+		toEvict.pop();
+		
+		lock.unlock();
+		sprite->Evict();
+		lock.lock();
+	}
 	
 	for(int i = 0; !toLoad.empty() && i < 100; ++i)
 	{
 		// Extract the one item we should work on uploading right now.
-		shared_ptr<ImageSet> imageSet = toLoad.front();
+		pair<shared_ptr<ImageSet>, Priority> entry = toLoad.front();
 		toLoad.pop();
+		const shared_ptr<ImageSet> &imageSet = entry.first;
 		
 		// It's now safe to modify the lists.
 		lock.unlock();
 		
-		imageSet->Upload(SpriteSet::Modify(imageSet->Name()));
+		{
+			Timeline::Scope scope("Upload sprite", imageSet->Name());
+			imageSet->Upload(SpriteSet::Modify(imageSet->Name()));
+		}
 		
 		lock.lock();
 		++completed;
+		completedBackground += (entry.second == Priority::BACKGROUND);
 	}
 	
-	// Wait until we have completed loading of as many sprites as we have added.
-	// The value of "added" is protected by readMutex.
+	// Wait until we have completed loading of as many sprites as we have added,
+	// not counting the background sprites. The values of "added" and
+	// "addedBackground" are protected by readMutex.
 	unique_lock<mutex> readLock(readMutex);
+	int total = added - addedBackground;
+	int done = completed - completedBackground;
 	// Special cases: we're bailing out, or we are done.
-	if(added <= 0 || added == completed)
+	if(added <= 0 || total == done)
 		return 1.;
-	return static_cast<double>(completed) / static_cast<double>(added);
+	return static_cast<double>(done) / static_cast<double>(total);
 }
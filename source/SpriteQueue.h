@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #define SPRITE_QUEUE_H_
 
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -30,8 +31,22 @@ class Sprite;
 
 
 // Class for queuing up a list of sprites to be loaded from the disk, with a set of
-// worker threads that begins loading them as soon as they are added.
+// worker threads that begins loading them as soon as they are added. Sprites are
+// loaded in order of priority, and in the order they were added within each
+// priority. Background sprites do not count toward the loading progress.
 class SpriteQueue {
+public:
+	enum class Priority : int {
+		// Sprites needed to draw the main menu and the rest of the interface.
+		INTERFACE = 0,
+		// Sprites that may be needed as soon as the player is in flight.
+		FLIGHT,
+		// Sprites that are only shown in panels, and can be loaded after the
+		// game has started.
+		BACKGROUND
+	};
+	
+	
 public:
 	SpriteQueue();
 	~SpriteQueue();
@@ -43,14 +58,26 @@ public:
 	SpriteQueue &operator=(SpriteQueue &&other) = delete;
 	
 	// Add a sprite to load.
-	void Add(const std::shared_ptr<ImageSet> &images);
+	void Add(const std::shared_ptr<ImageSet> &images, Priority priority = Priority::FLIGHT);
+	// If the given sprite has not been read from disk yet, read it next.
+	void Prioritize(const std::string &name);
 	// Unload the texture for the given sprite (to free up memory).
 	void Unload(const std::string &name);
-	// Upload more images and find out our percent completion.
+	// Unload the texture for the given sprite, but keep its dimensions and
+	// collision masks so that it can still be used until it is loaded again.
+	void Evict(const std::string &name);
+	// Upload more images and find out our percent completion, not counting any
+	// background sprites.
 	// TODO: make this a const accessor.
 	double Progress();
-	// Finish loading.
+	// Check if every sprite, including the background sprites, has been loaded.
+	bool IsFinished();
+	// Finish loading everything but the background sprites, which may keep
+	// loading while the game is running.
 	void Finish();
+	// Stop the worker threads, once they finish reading whatever sprites they
+	// are working on. No more sprites can be loaded after this.
+	void Stop();
 	
 	// Thread entry point.
 	void operator()();
@@ -61,20 +88,24 @@ private:
 	
 	
 private:
-	// These are the image sets that need to be loaded from disk.
-	std::queue<std::shared_ptr<ImageSet>> toRead;
+	// These are the image sets that need to be loaded from disk, for each
+	// priority. Each is stored along with the priority it was added with.
+	std::deque<std::pair<std::shared_ptr<ImageSet>, Priority>> toRead[3];
 	std::mutex readMutex;
 	std::condition_variable readCondition;
 	int added = 0;
+	int addedBackground = 0;
 	
 	// These image sets have been loaded from disk but have not been uplodaed.
-	std::queue<std::shared_ptr<ImageSet>> toLoad;
+	std::queue<std::pair<std::shared_ptr<ImageSet>, Priority>> toLoad;
 	std::mutex loadMutex;
 	std::condition_variable loadCondition;
 	int completed = 0;
+	int completedBackground = 0;
 	
 	// These sprites must be unloaded to reclaim GPU memory.
 	std::queue<std::string> toUnload;
+	std::queue<std::string> toEvict;
 	
 	// Worker threads for loading sprites from disk.
 	std::vector<std::thread> threads;
@@ -392,7 +392,7 @@ void System::Load(const DataNode &node, Set<Planet> &planets)
 // Update any information about the system that may have changed due to events,
 // or because the game was started, e.g. neighbors, solar wind and power, or
 // if the system is inhabited.
-void System::UpdateSystem(const Set<System> &systems, const set<double> &neighborDistances)
+void System::UpdateSystem(const vector<const System *> &nearby, const set<double> &neighborDistances)
 {
 	neighbors.clear();
 	// Neighbors are cached for each system for the purpose of quicker
@@ -402,15 +402,15 @@ void System::UpdateSystem(const Set<System> &systems, const set<double> &neighbo
 	// jump range that can be encountered.
 	if(jumpRange)
 	{
-		UpdateNeighbors(systems, jumpRange);
+		UpdateNeighbors(nearby, jumpRange);
 		// Systems with a static jump range must also create a set for
 		// the DEFAULT_NEIGHBOR_DISTANCE to be returned for those systems
 		// which are visible from it.
-		UpdateNeighbors(systems, DEFAULT_NEIGHBOR_DISTANCE);
+		UpdateNeighbors(nearby, DEFAULT_NEIGHBOR_DISTANCE);
 	}
 	else
 		for(const double distance : neighborDistances)
-			UpdateNeighbors(systems, distance);
+			UpdateNeighbors(nearby, distance);
 	
 	// Calculate the solar power and solar wind.
 	solarPower = 0.;
@@ -774,6 +774,14 @@ double System::Exports(const string &commodity) const
 
 
 
+System::Price *System::GetPrice(const string &commodity)
+{
+	auto it = trade.find(commodity);
+	return (it == trade.end()) ? nullptr : &it->second;
+}
+
+
+
 // Get the probabilities of various fleets entering this system.
 const vector<System::FleetProbability> &System::Fleets() const
 {
@@ -848,7 +856,7 @@ void System::LoadObject(const DataNode &node, Set<Planet> &planets, int parent)
 // Once the star map is fully loaded or an event has changed systems
 // or links, figure out which stars are "neighbors" of this one, i.e.
 // close enough to see or to reach via jump drive.
-void System::UpdateNeighbors(const Set<System> &systems, double distance)
+void System::UpdateNeighbors(const vector<const System *> &nearby, double distance)
 {
 	set<const System *> &neighborSet = neighbors[distance];
 	
@@ -859,15 +867,9 @@ void System::UpdateNeighbors(const Set<System> &systems, double distance)
 	
 	// Any other star system that is within the neighbor distance is also a
 	// neighbor.
-	for(const auto &it : systems)
-	{
-		// Skip systems that have no name.
-		if(it.first.empty() || it.second.Name().empty())
-			continue;
-
-		if(&it.second != this && it.second.Position().Distance(position) <= distance)
-			neighborSet.insert(&it.second);
-	}
+	for(const System *system : nearby)
+		if(system != this && system->Position().Distance(position) <= distance)
+			neighborSet.insert(system);
 }
 
 
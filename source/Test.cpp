@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Test.h"
 
+#include "ConditionsStore.h"
 #include "DataNode.h"
 #include "Files.h"
 #include "GameData.h"
@@ -542,9 +543,9 @@ void Test::Fail(const Context &context, const PlayerInfo &player, const string &
 	// Future versions of the test-framework could also print all conditions that are used in the test.
 	string conditions = "";
 	const string TEST_PREFIX = "test: ";
-	auto it = player.Conditions().lower_bound(TEST_PREFIX);
-	for( ; it != player.Conditions().end() && !it->first.compare(0, TEST_PREFIX.length(), TEST_PREFIX); ++it)
-		conditions += "Condition: \"" + it->first + "\" = " + to_string(it->second) + "\n";
+	for(int id : player.Conditions().Ids(TEST_PREFIX))
+		conditions += "Condition: \"" + ConditionsStore::Name(id) + "\" = "
+			+ to_string(player.Conditions().Get(id)) + "\n";
 	
 	if(!conditions.empty())
 		Files::LogError(conditions);
@@ -0,0 +1,207 @@
+/* TextureAtlas.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "TextureAtlas.h"
+
+#include "gl_header.h"
+#include "ImageBuffer.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+	// Each page is a square texture of this size, in pixels.
+	const int PAGE_SIZE = 2048;
+	// Only sprites whose frames are no larger than this are packed.
+	const int MAX_FRAME_SIZE = 256;
+	// A single sprite may not take up more than this fraction of a page.
+	const int MAX_SPRITE_AREA = PAGE_SIZE * PAGE_SIZE / 4;
+	// Each frame is surrounded by a one pixel border that copies its edges, so
+	// that linear filtering never blends in pixels from a neighboring frame.
+	const int PADDING = 1;
+	
+	// Frames are packed in "shelves:" rows of frames, each as tall as the
+	// first frame that was placed in it.
+	class Shelf {
+	public:
+		int y;
+		int height;
+		int width;
+	};
+	
+	class Page {
+	public:
+		uint32_t texture = 0;
+		vector<Shelf> shelves;
+		int height = 0;
+		// The number of frames that are currently stored in this page.
+		int frames = 0;
+	};
+	
+	vector<Page> pages;
+	
+	
+	// Find a place for a frame of the given size in the given page. Return
+	// false if there is no room for it.
+	bool Place(Page &page, int width, int height, int &x, int &y)
+	{
+		// Use the first shelf that this frame fits in, as long as the shelf
+		// is not so much taller than the frame that space would be wasted.
+		for(Shelf &shelf : page.shelves)
+			if(shelf.height >= height && shelf.height <= 2 * height && shelf.width + width <= PAGE_SIZE)
+			{
+				x = shelf.width;
+				y = shelf.y;
+				shelf.width += width;
+				return true;
+			}
+		
+		if(page.height + height > PAGE_SIZE)
+			return false;
+		
+		page.shelves.push_back(Shelf{page.height, height, width});
+		x = 0;
+		y = page.height;
+		page.height += height;
+		return true;
+	}
+	
+	
+	// Place all the frames of the given sprite in the given page, or none of
+	// them if they will not all fit.
+	bool PlaceAll(Page &page, int width, int height, int frames, vector<pair<int, int>> &positions)
+	{
+		Page result = page;
+		positions.resize(frames);
+		for(pair<int, int> &position : positions)
+			if(!Place(result, width, height, position.first, position.second))
+				return false;
+		
+		page = move(result);
+		return true;
+	}
+	
+	
+	// Create a new page texture, with all its pixels transparent.
+	Page CreatePage()
+	{
+		Page page;
+		glGenTextures(1, &page.texture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+		
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		
+		vector<uint32_t> empty(PAGE_SIZE * PAGE_SIZE, 0);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, PAGE_SIZE, PAGE_SIZE, 1,
+			0, GL_RGBA, GL_UNSIGNED_BYTE, empty.data());
+		
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		return page;
+	}
+}
+
+
+
+// Check if the sprite with the given name and image data should be packed.
+// Only sprites that are drawn by the BatchShader benefit from being packed.
+bool TextureAtlas::ShouldPack(const string &name, const ImageBuffer &buffer)
+{
+	// Projectiles and effects are drawn by the BatchShader. (Some effects are
+	// also drawn on their own, but those use the sprite's own texture.)
+	if(name.compare(0, 11, "projectile/") && name.compare(0, 7, "effect/"))
+		return false;
+	
+	int width = buffer.Width() + 2 * PADDING;
+	int height = buffer.Height() + 2 * PADDING;
+	return (buffer.Width() <= MAX_FRAME_SIZE && buffer.Height() <= MAX_FRAME_SIZE
+		&& width * height * buffer.Frames() <= MAX_SPRITE_AREA);
+}
+
+
+
+// Copy every frame in the given buffer into the atlas. Return the texture
+// that they were placed in, and fill in the region of each frame.
+uint32_t TextureAtlas::Add(const ImageBuffer &buffer, vector<Region> &regions)
+{
+	int width = buffer.Width() + 2 * PADDING;
+	int height = buffer.Height() + 2 * PADDING;
+	int frames = buffer.Frames();
+	
+	vector<pair<int, int>> positions;
+	auto page = pages.begin();
+	for( ; page != pages.end(); ++page)
+		if(PlaceAll(*page, width, height, frames, positions))
+			break;
+	if(page == pages.end())
+	{
+		pages.push_back(CreatePage());
+		page = pages.end() - 1;
+		if(!PlaceAll(*page, width, height, frames, positions))
+			return 0;
+	}
+	page->frames += frames;
+	
+	// Copy each frame into the page, along with its border.
+	vector<uint32_t> padded(width * height);
+	regions.resize(frames);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, page->texture);
+	for(int i = 0; i < frames; ++i)
+	{
+		for(int y = 0; y < height; ++y)
+		{
+			int sourceY = min(max(y - PADDING, 0), buffer.Height() - 1);
+			const uint32_t *source = buffer.Begin(sourceY, i);
+			uint32_t *row = &padded[y * width];
+			for(int x = 0; x < width; ++x)
+				row[x] = source[min(max(x - PADDING, 0), buffer.Width() - 1)];
+		}
+		
+		int x = positions[i].first;
+		int y = positions[i].second;
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, 0, width, height, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, padded.data());
+		
+		Region &region = regions[i];
+		region.left = static_cast<float>(x + PADDING) / PAGE_SIZE;
+		region.top = static_cast<float>(y + PADDING) / PAGE_SIZE;
+		region.right = static_cast<float>(x + width - PADDING) / PAGE_SIZE;
+		region.bottom = static_cast<float>(y + height - PADDING) / PAGE_SIZE;
+		region.layer = 0.f;
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	
+	return page->texture;
+}
+
+
+
+// Release the space used by the given frames. A page's space is reused
+// once all the frames that were placed in it have been removed.
+void TextureAtlas::Remove(uint32_t texture, const vector<Region> &regions)
+{
+	for(Page &page : pages)
+		if(page.texture == texture)
+		{
+			page.frames -= static_cast<int>(regions.size());
+			if(page.frames <= 0)
+			{
+				page.frames = 0;
+				page.shelves.clear();
+				page.height = 0;
+			}
+			return;
+		}
+}
@@ -0,0 +1,58 @@
+/* TextureAtlas.h
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef TEXTURE_ATLAS_H_
+#define TEXTURE_ATLAS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ImageBuffer;
+
+
+
+// Class for packing the frames of small sprites into shared textures, so that
+// the BatchShader can draw many different sprites with a single texture bind
+// and a single draw call. Each page of the atlas is an array texture with one
+// layer, so the same shader can draw sprites whether or not they are packed.
+// All the frames of a sprite are always placed on the same page. This must
+// only be used from the thread that owns the OpenGL context.
+class TextureAtlas {
+public:
+	// The texture coordinates of one frame: the (s, t) coordinates that the
+	// corners (0, 0) and (1, 1) of the frame map to, and the array layer.
+	class Region {
+	public:
+		float left = 0.f;
+		float top = 0.f;
+		float right = 1.f;
+		float bottom = 1.f;
+		float layer = 0.f;
+	};
+	
+	
+public:
+	// Check if the sprite with the given name and image data should be packed.
+	// Only sprites that are drawn by the BatchShader benefit from being packed.
+	static bool ShouldPack(const std::string &name, const ImageBuffer &buffer);
+	// Copy every frame in the given buffer into the atlas. Return the texture
+	// that they were placed in, and fill in the region of each frame.
+	static uint32_t Add(const ImageBuffer &buffer, std::vector<Region> &regions);
+	// Release the space used by the given frames. A page's space is reused
+	// once all the frames that were placed in it have been removed.
+	static void Remove(uint32_t texture, const std::vector<Region> &regions);
+};
+
+
+
+#endif
@@ -0,0 +1,255 @@
+/* TextureCache.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "TextureCache.h"
+
+#include "File.h"
+#include "Files.h"
+#include "ImageBuffer.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Change this whenever the format of the cache file or the way that images
+	// are converted changes, so that old cache files are discarded. The magic
+	// number also detects a cache file written with a different byte order.
+	const uint32_t MAGIC = 0x45535458;
+	const uint32_t VERSION = 1;
+	// Stop adding to the cache once it reaches this size, so that offsets can
+	// always be stored in a long, even on systems where it is 32 bits.
+	const long MAX_SIZE = 0x70000000;
+	
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+	};
+	
+	// Each frame is stored as this record, followed by the path and then the
+	// pixels, one row after another.
+	struct Record {
+		int64_t timestamp;
+		uint32_t pathLength;
+		uint32_t width;
+		uint32_t height;
+		uint32_t checksum;
+	};
+	
+	struct Entry {
+		long offset;
+		Record record;
+	};
+	
+	mutex cacheMutex;
+	bool isLoaded = false;
+	map<string, Entry> entries;
+	FILE *output = nullptr;
+	long size = 0;
+	
+	string CachePath()
+	{
+		return Files::Config() + "texture cache.bin";
+	}
+	
+	// Compute a checksum of the pixels, to detect a corrupt cache file.
+	uint32_t Checksum(const uint32_t *it, const uint32_t *end)
+	{
+		uint32_t checksum = 2166136261u;
+		for( ; it != end; ++it)
+			checksum = (checksum ^ *it) * 16777619u;
+		return checksum;
+	}
+	
+	// Read the header of each record in the cache file, skipping the pixels.
+	// Return the number of bytes in records for images that are out of date,
+	// or -1 if the file is invalid.
+	long Index(FILE *file)
+	{
+		if(fseek(file, 0, SEEK_END))
+			return -1;
+		long length = ftell(file);
+		rewind(file);
+		
+		Header header;
+		if(fread(&header, sizeof(header), 1, file) != 1 || header.magic != MAGIC || header.version != VERSION)
+			return -1;
+		
+		size = sizeof(header);
+		Record record;
+		string path;
+		while(size < length)
+		{
+			if(fread(&record, sizeof(record), 1, file) != 1)
+				return -1;
+			if(!record.pathLength || record.pathLength > 4096 || !record.width || !record.height
+					|| record.width > 16384 || record.height > 16384)
+				return -1;
+			path.resize(record.pathLength);
+			if(fread(&path[0], 1, path.size(), file) != path.size())
+				return -1;
+			
+			long offset = size + sizeof(record) + path.size();
+			long bytes = 4l * record.width * record.height;
+			if(offset + bytes > length || fseek(file, bytes, SEEK_CUR))
+				return -1;
+			size = offset + bytes;
+			
+			// If an image is in the cache more than once, the last copy is the
+			// most recent.
+			Entry &entry = entries[path];
+			entry.offset = offset;
+			entry.record = record;
+		}
+		
+		long current = sizeof(header);
+		for(const auto &it : entries)
+			if(it.second.record.timestamp == Files::Timestamp(it.first))
+				current += sizeof(Record) + it.first.size() + 4l * it.second.record.width * it.second.record.height;
+		return size - current;
+	}
+}
+
+
+
+// Open the cache file and index its contents. If it is corrupt or from a
+// different version of the cache format, or if most of it is out of date,
+// it is deleted and a new cache is started.
+void TextureCache::Load()
+{
+	lock_guard<mutex> lock(cacheMutex);
+	if(isLoaded)
+		return;
+	isLoaded = true;
+	
+	string path = CachePath();
+	bool isNew = true;
+	if(Files::Exists(path))
+	{
+		long stale = 0;
+		{
+			File file(path);
+			stale = file ? Index(file) : -1;
+		}
+		if(stale < 0)
+			Files::LogError("Discarding the texture cache because it is invalid or out of date.");
+		if(stale < 0 || stale > size / 2)
+		{
+			entries.clear();
+			Files::Delete(path);
+		}
+		else
+			isNew = false;
+	}
+	
+	output = Files::OpenAppend(path);
+	if(!output)
+	{
+		Files::LogError("Unable to write to the texture cache: \"" + path + "\"");
+		return;
+	}
+	if(isNew)
+	{
+		Header header = {MAGIC, VERSION};
+		fwrite(&header, sizeof(header), 1, output);
+		fflush(output);
+		size = sizeof(header);
+	}
+}
+
+
+
+// Read the given image's frame from the cache, if it has not been modified
+// since it was cached. The buffer is allocated if it was not already.
+bool TextureCache::Read(const string &path, ImageBuffer &buffer, int frame)
+{
+	Entry entry;
+	{
+		lock_guard<mutex> lock(cacheMutex);
+		auto it = entries.find(path);
+		if(it == entries.end())
+			return false;
+		entry = it->second;
+	}
+	const Record &record = entry.record;
+	if(record.timestamp != Files::Timestamp(path))
+		return false;
+	
+	int width = record.width;
+	int height = record.height;
+	buffer.Allocate(width, height);
+	if(width != buffer.Width() || height != buffer.Height())
+		return false;
+	
+	File file(CachePath());
+	if(!file || fseek(file, entry.offset, SEEK_SET))
+		return false;
+	uint32_t *begin = buffer.Begin(0, frame);
+	uint32_t *end = begin + width * height;
+	if(fread(begin, sizeof(uint32_t), end - begin, file) != static_cast<size_t>(end - begin))
+		return false;
+	
+	if(Checksum(begin, end) != record.checksum)
+	{
+		Files::LogError("Texture cache entry is corrupt: \"" + path + "\"");
+		lock_guard<mutex> lock(cacheMutex);
+		entries.erase(path);
+		return false;
+	}
+	return true;
+}
+
+
+
+// Add the given frame, which was decoded from the given image, to the cache.
+void TextureCache::Add(const string &path, const ImageBuffer &buffer, int frame)
+{
+	if(!isLoaded)
+		return;
+	
+	const uint32_t *begin = buffer.Begin(0, frame);
+	const uint32_t *end = begin + buffer.Width() * buffer.Height();
+	Record record;
+	record.timestamp = Files::Timestamp(path);
+	record.pathLength = path.size();
+	record.width = buffer.Width();
+	record.height = buffer.Height();
+	record.checksum = Checksum(begin, end);
+	long bytes = sizeof(record) + path.size() + 4l * record.width * record.height;
+	
+	lock_guard<mutex> lock(cacheMutex);
+	if(!output || size + bytes > MAX_SIZE)
+		return;
+	
+	bool written = fwrite(&record, sizeof(record), 1, output) == 1
+		&& fwrite(path.data(), 1, path.size(), output) == path.size()
+		&& fwrite(begin, sizeof(uint32_t), end - begin, output) == static_cast<size_t>(end - begin);
+	// Make sure the data is on disk before another thread tries to read it.
+	if(!written || fflush(output))
+	{
+		// The file may now end with a partial record, so no more records can
+		// be added after it. It will be discarded the next time it is loaded.
+		fclose(output);
+		output = nullptr;
+		return;
+	}
+	
+	Entry &entry = entries[path];
+	entry.offset = size + sizeof(record) + path.size();
+	entry.record = record;
+	size += bytes;
+}
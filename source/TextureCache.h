@@ -0,0 +1,44 @@
+/* TextureCache.h
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef TEXTURE_CACHE_H_
+#define TEXTURE_CACHE_H_
+
+#include <string>
+
+class ImageBuffer;
+
+
+
+// Class for storing decoded image frames, already converted to premultiplied
+// alpha or to additive blending, in one file in the config directory. Reading
+// a frame from the cache is much faster than decoding a PNG or JPEG. Each frame
+// is identified by the path and modification time of the image it came from.
+// The cache is only used if the game is started with "--texture-cache", because
+// it takes up several hundred megabytes. Read() and Add() may be called from
+// any of the image-loading threads.
+class TextureCache {
+public:
+	// Open the cache file and index its contents. If it is corrupt or from a
+	// different version of the cache format, or if most of it is out of date,
+	// it is deleted and a new cache is started.
+	static void Load();
+	// Read the given image's frame from the cache, if it has not been modified
+	// since it was cached. The buffer is allocated if it was not already.
+	static bool Read(const std::string &path, ImageBuffer &buffer, int frame);
+	// Add the given frame, which was decoded from the given image, to the cache.
+	static void Add(const std::string &path, const ImageBuffer &buffer, int frame);
+};
+
+
+
+#endif
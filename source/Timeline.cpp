@@ -0,0 +1,220 @@
+/* Timeline.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Timeline.h"
+
+#include "Files.h"
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	class Event {
+	public:
+		const char *name;
+		string detail;
+		int thread;
+		chrono::steady_clock::time_point start;
+		chrono::steady_clock::time_point end;
+	};
+	
+	// Recording is only done if this is set, so checking it must not require
+	// taking the lock.
+	atomic<bool> isEnabled(false);
+	string outputPath;
+	chrono::steady_clock::time_point origin;
+	
+	mutex timelineMutex;
+	vector<Event> events;
+	// Each thread is identified in the output by a small number.
+	map<thread::id, int> threadIndex;
+	map<int, string> threadNames;
+	
+	
+	// Get the index of the calling thread. The mutex must already be locked.
+	int ThreadIndex()
+	{
+		auto it = threadIndex.find(this_thread::get_id());
+		if(it != threadIndex.end())
+			return it->second;
+		
+		int index = threadIndex.size() + 1;
+		threadIndex[this_thread::get_id()] = index;
+		return index;
+	}
+	
+	
+	
+	// Convert a time point to the number of microseconds since the start of
+	// the timeline, as the trace format expects.
+	long long Microseconds(chrono::steady_clock::time_point time)
+	{
+		return chrono::duration_cast<chrono::microseconds>(time - origin).count();
+	}
+	
+	
+	
+	// Escape the given text so that it can be written as a JSON string.
+	string Quote(const string &text)
+	{
+		string result = "\"";
+		for(char c : text)
+		{
+			if(c == '"' || c == '\\')
+			{
+				result += '\\';
+				result += c;
+			}
+			else if(static_cast<unsigned char>(c) < 0x20)
+			{
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				result += buffer;
+			}
+			else
+				result += c;
+		}
+		return result + '"';
+	}
+}
+
+
+
+Timeline::Scope::Scope(const char *name)
+	: name(name)
+{
+	if(isEnabled)
+		start = chrono::steady_clock::now();
+}
+
+
+
+Timeline::Scope::Scope(const char *name, const string &detail)
+	: name(name)
+{
+	if(isEnabled)
+	{
+		this->detail = detail;
+		start = chrono::steady_clock::now();
+	}
+}
+
+
+
+Timeline::Scope::~Scope()
+{
+	if(isEnabled)
+		Record(name, detail, start);
+}
+
+
+
+// Check the command line for the timeline option, and if it is given, start
+// recording. The time of this call is the start of the timeline.
+void Timeline::Init(const char * const *argv)
+{
+	for(const char * const *it = argv + 1; *it; ++it)
+	{
+		string arg = *it;
+		if(arg == "--timeline" && *++it)
+			outputPath = *it;
+	}
+	if(outputPath.empty())
+		return;
+	
+	origin = chrono::steady_clock::now();
+	isEnabled = true;
+	NameThread("main");
+}
+
+
+
+bool Timeline::IsEnabled()
+{
+	return isEnabled;
+}
+
+
+
+// Give the calling thread a name to show in the timeline.
+void Timeline::NameThread(const string &name)
+{
+	if(!isEnabled)
+		return;
+	
+	lock_guard<mutex> lock(timelineMutex);
+	threadNames[ThreadIndex()] = name;
+}
+
+
+
+// Record an event that began at the given time and ends now.
+void Timeline::Record(const char *name, const string &detail, chrono::steady_clock::time_point start)
+{
+	if(!isEnabled)
+		return;
+	
+	auto end = chrono::steady_clock::now();
+	lock_guard<mutex> lock(timelineMutex);
+	events.push_back(Event{name, detail, ThreadIndex(), start, end});
+}
+
+
+
+// Write everything recorded so far to the file given on the command line,
+// along with one event spanning from the start of the timeline until now.
+void Timeline::Write(const char *name)
+{
+	if(!isEnabled)
+		return;
+	
+	Record(name, string(), origin);
+	
+	lock_guard<mutex> lock(timelineMutex);
+	string out = "{\"traceEvents\":[\n";
+	for(const auto &it : threadNames)
+		out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + to_string(it.first)
+			+ ",\"args\":{\"name\":" + Quote(it.second) + "}},\n";
+	for(const Event &event : events)
+	{
+		out += "{\"name\":" + Quote(event.name) + ",\"cat\":\"load\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+			+ to_string(event.thread) + ",\"ts\":" + to_string(Microseconds(event.start))
+			+ ",\"dur\":" + to_string(Microseconds(event.end) - Microseconds(event.start));
+		if(!event.detail.empty())
+			out += ",\"args\":{\"detail\":" + Quote(event.detail) + "}";
+		out += "},\n";
+	}
+	// The trace format does not allow a trailing comma.
+	out.resize(out.size() - 2);
+	out += "\n]}\n";
+	
+	Files::Write(outputPath, out);
+}
+
+
+
+// Stop recording. Anything recorded after the last write would never be
+// saved, so this keeps the timeline from growing for the whole session.
+void Timeline::Stop()
+{
+	isEnabled = false;
+	
+	lock_guard<mutex> lock(timelineMutex);
+	events.clear();
+	events.shrink_to_fit();
+}
@@ -0,0 +1,65 @@
+/* Timeline.h
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#include <chrono>
+#include <string>
+
+
+
+// Class for recording when each stage of loading the game begins and ends, on
+// every thread that does any of the work. If the "--timeline <path>" command
+// line option is given, the recorded timeline is written to that path in the
+// Chrome trace event format, which can be viewed in chrome://tracing or in
+// Perfetto. Otherwise, recording does nothing.
+class Timeline {
+public:
+	// Record an event by creating one of these objects; the event ends when
+	// the object goes out of scope. The name must be a string literal.
+	class Scope {
+	public:
+		explicit Scope(const char *name);
+		Scope(const char *name, const std::string &detail);
+		~Scope();
+		
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+		
+	private:
+		const char *name;
+		std::string detail;
+		std::chrono::steady_clock::time_point start;
+	};
+	
+	
+public:
+	// Check the command line for the timeline option, and if it is given, start
+	// recording. The time of this call is the start of the timeline.
+	static void Init(const char * const *argv);
+	static bool IsEnabled();
+	// Give the calling thread a name to show in the timeline.
+	static void NameThread(const std::string &name);
+	// Record an event that began at the given time and ends now.
+	static void Record(const char *name, const std::string &detail, std::chrono::steady_clock::time_point start);
+	// Write everything recorded so far to the file given on the command line,
+	// along with one event spanning from the start of the timeline until now.
+	static void Write(const char *name);
+	// Stop recording. Anything recorded after the last write would never be
+	// saved, so this keeps the timeline from growing for the whole session.
+	static void Stop();
+};
+
+
+
+#endif
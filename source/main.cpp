@@ -13,11 +13,13 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 */
 
 #include "Audio.h"
+#include "BinaryData.h"
 #include "Command.h"
 #include "Conversation.h"
 #include "ConversationPanel.h"
 #include "DataFile.h"
 #include "DataNode.h"
+#include "DataWriter.h"
 #include "Dialog.h"
 #include "Files.h"
 #include "text/Font.h"
@@ -32,12 +34,14 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "SpriteSet.h"
 #include "SpriteShader.h"
 #include "Test.h"
+#include "Timeline.h"
 #include "UI.h"
 
 #include <chrono>
 #include <iostream>
 #include <map>
 
+#include <sstream>
 #include <stdexcept>
 #include <string>
 
@@ -52,6 +56,7 @@ using namespace std;
 
 void PrintHelp();
 void PrintVersion();
+int ConvertSave(const string &from, const string &to);
 void GameLoop(PlayerInfo &player, const Conversation &conversation, const string &testToRun, bool debugMode);
 Conversation LoadConversation();
 #ifdef _WIN32
@@ -94,27 +99,45 @@ int main(int argc, char *argv[])
 			loadOnly = true;
 		else if(arg == "--test" && *++it)
 			testToRunName = *it;
+		else if(arg == "--convert-save" && it[1] && it[2])
+			return ConvertSave(it[1], it[2]);
 	}
 	
+	// Start recording the loading timeline, if requested.
+	Timeline::Init(argv);
+	
 	try {
 		// Begin loading the game data. Exit early if we are not using the UI.
-		if(!GameData::BeginLoad(argv))
-			return 0;
+		{
+			Timeline::Scope scope("GameData::BeginLoad");
+			if(!GameData::BeginLoad(argv))
+			{
+				GameData::Quit();
+				return 0;
+			}
+		}
 		
 		if(!testToRunName.empty() && !GameData::Tests().Has(testToRunName))
 		{
 			Files::LogError("Test \"" + testToRunName + "\" not found.");
+			GameData::Quit();
 			return 1;
 		}
 		
 		// Load player data, including reference-checking.
 		PlayerInfo player;
-		bool checkedReferences = player.LoadRecent();
+		bool checkedReferences = false;
+		{
+			Timeline::Scope scope("PlayerInfo::LoadRecent");
+			checkedReferences = player.LoadRecent();
+		}
 		if(loadOnly)
 		{
 			if(!checkedReferences)
 				GameData::CheckReferences();
+			Timeline::Write("Parse save");
 			cout << "Parse completed." << endl;
+			GameData::Quit();
 			return 0;
 		}
 		
@@ -126,22 +149,36 @@ int main(int argc, char *argv[])
 		
 		Preferences::Load();
 		
-		if(!GameWindow::Init())
-			return 1;
+		{
+			Timeline::Scope scope("GameWindow::Init");
+			if(!GameWindow::Init())
+			{
+				GameData::Quit();
+				return 1;
+			}
+		}
 		
-		GameData::LoadShaders(!GameWindow::HasSwizzle());
+		{
+			Timeline::Scope scope("GameData::LoadShaders");
+			GameData::LoadShaders(!GameWindow::HasSwizzle());
+		}
 		
 		// Show something other than a blank window.
 		GameWindow::Step();
 		
-		Audio::Init(GameData::Sources());
+		{
+			Timeline::Scope scope("Audio::Init");
+			Audio::Init(GameData::Sources());
+		}
 		
 		// This is the main loop where all the action begins.
 		GameLoop(player, conversation, testToRunName, debugMode);
 	}
 	catch(const runtime_error &error)
 	{
+		PlayerInfo::FinishSaving();
 		Audio::Quit();
+		GameData::Quit();
 		bool doPopUp = testToRunName.empty();
 		GameWindow::ExitWithError(error.what(), doPopUp);
 		return 1;
@@ -154,6 +191,7 @@ int main(int argc, char *argv[])
 	Preferences::Save();
 	
 	Audio::Quit();
+	GameData::Quit();
 	GameWindow::Quit();
 	
 	return 0;
@@ -324,6 +362,7 @@ void GameLoop(PlayerInfo &player, const Conversation &conversation, const string
 	// If player quit while landed on a planet, save the game if there are changes.
 	if(player.GetPlanet() && gamePanels.CanSave())
 		player.Save();
+	PlayerInfo::FinishSaving();
 }
 
 
@@ -341,8 +380,15 @@ void PrintHelp()
 	cerr << "    -c, --config <path>: save user's files to given directory." << endl;
 	cerr << "    -d, --debug: turn on debugging features (e.g. Caps Lock slows down instead of speeds up)." << endl;
 	cerr << "    -p, --parse-save: load the most recent saved game and inspect it for content errors" << endl;
+	cerr << "    --convert-save <from> <to>: convert a saved game between the text and compact" << endl;
+	cerr << "        binary formats, then exit." << endl;
+	cerr << "    --hot-reload: reload data files and images that change while the game is running." << endl;
+	cerr << "    --texture-cache: keep decoded images in the config directory to load them faster" << endl;
+	cerr << "        (uses several hundred megabytes of disk space)." << endl;
 	cerr << "    --tests: print table of available tests, then exit." << endl;
 	cerr << "    --test <name>: run given test from resources directory" << endl;
+	cerr << "    --timeline <path>: write a timeline of the loading stages to the given file," << endl;
+	cerr << "        in Chrome's trace event format." << endl;
 	cerr << endl;
 	cerr << "Report bugs to: <https://github.com/endless-sky/endless-sky/issues>" << endl;
 	cerr << "Home page: <https://endless-sky.github.io>" << endl;
@@ -351,6 +397,35 @@ void PrintHelp()
 
 
 
+// Write a copy of the given saved game (or any data file) in the other format:
+// binary if it is text, or text if it is binary.
+int ConvertSave(const string &from, const string &to)
+{
+	string data = Files::Read(from);
+	if(data.empty())
+	{
+		cerr << "Unable to read \"" << from << "\"." << endl;
+		return 1;
+	}
+	bool toBinary = !BinaryData::IsBinary(data);
+	istringstream in(data);
+	DataFile file(in);
+	{
+		DataWriter out(to, toBinary ? DataWriter::Encoding::BINARY : DataWriter::Encoding::TEXT);
+		for(const DataNode &node : file)
+		{
+			out.Write(node);
+			// Keep the summary in a section of its own, as the game does.
+			if(node.Token(0) == "summary")
+				out.EndSection();
+		}
+	}
+	cout << "Converted \"" << from << "\" to " << (toBinary ? "binary." : "text.") << endl;
+	return 0;
+}
+
+
+
 void PrintVersion()
 {
 	cerr << endl;
@@ -227,6 +227,10 @@ string Format::Replace(const string &source, const map<string, string> &keys)
 	string result;
 	result.reserve(source.length());
 	
+	// Each "<" begins a possible key, which runs up to the first ">" after it.
+	// Rather than checking every key against it, look it up directly, reusing
+	// the same buffer for each one so the whole string is copied in one pass.
+	string key;
 	size_t start = 0;
 	size_t search = start;
 	while(search < source.length())
@@ -239,21 +243,17 @@ string Format::Replace(const string &source, const map<string, string> &keys)
 		if(right == string::npos)
 			break;
 		
-		bool matched = false;
 		++right;
-		size_t length = right - left;
-		for(const auto &it : keys)
-			if(!source.compare(left, length, it.first))
-			{
-				result.append(source, start, left - start);
-				result.append(it.second);
-				start = right;
-				search = start;
-				matched = true;
-				break;
-			}
-		
-		if(!matched)
+		key.assign(source, left, right - left);
+		auto it = keys.find(key);
+		if(it != keys.end())
+		{
+			result.append(source, start, left - start);
+			result.append(it->second);
+			start = right;
+			search = start;
+		}
+		else
 			search = left + 1;
 	}
 	
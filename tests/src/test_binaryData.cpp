@@ -0,0 +1,163 @@
+/* test_binaryData.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../source/BinaryData.h"
+
+// ... and any system includes needed for the test file.
+#include "../../source/DataFile.h"
+#include "../../source/DataNode.h"
+#include "../../source/DataWriter.h"
+
+#include <sstream>
+#include <string>
+
+namespace { // test namespace
+
+// #region mock data
+const std::string TEXT = R"(pilot Bobbi Bughunter
+date 16 11 3013
+system Sol
+"reputation with"
+	Author 1
+	"Bad Trip" -1000
+	Deep 0.25
+conditions
+	"ships: Star Barge" -0
+	"numbers like" 007
+	"and like" +5
+	`"quoted" text` "with space"
+	"big number" 123456789012345678901234
+account
+	credits 131000
+	mortgage Mortgage 480000
+		interest 0.004
+		term 365
+ship "Star Barge"
+	name "Buggy Barge"
+)";
+
+// Load a data file from a string, which may be text or binary.
+std::string Write(const std::string &data, DataWriter::Encoding encoding)
+{
+	std::istringstream in(data);
+	DataFile file(in);
+	DataWriter out(encoding);
+	for(const DataNode &node : file)
+		out.Write(node);
+	return out.Contents();
+}
+
+// List the tokens of each node and of its children.
+std::string Flatten(const DataNode &root)
+{
+	std::ostringstream text;
+	for(const DataNode &node : root)
+	{
+		for(const std::string &token : node.Tokens())
+			text << token << ',';
+		text << '{';
+		for(const DataNode &child : node)
+			for(const std::string &token : child.Tokens())
+				text << token << ',';
+		text << '}';
+	}
+	return text.str();
+}
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Converting data between text and binary", "[BinaryData]" ) {
+	GIVEN( "A data file in text form" ) {
+		WHEN( "it is converted to binary" ) {
+			const std::string binary = Write(TEXT, DataWriter::Encoding::BINARY);
+			THEN( "the result is recognized as binary data" ) {
+				CHECK( BinaryData::IsBinary(binary) );
+				CHECK_FALSE( BinaryData::IsBinary(TEXT) );
+			}
+			THEN( "converting it back to text gives the original text" ) {
+				CHECK( Write(binary, DataWriter::Encoding::TEXT) == TEXT );
+			}
+			THEN( "converting it to binary again gives the same data" ) {
+				CHECK( Write(binary, DataWriter::Encoding::BINARY) == binary );
+			}
+		}
+	}
+	GIVEN( "Data written directly in binary" ) {
+		DataWriter out(DataWriter::Encoding::BINARY);
+		out.Write("first", 1, -2.5, "two words");
+		out.WriteComment("This is not kept.");
+		out.BeginChild();
+		{
+			out.Write("child", -7);
+			out.Write();
+			out.Write("second child");
+		}
+		out.EndChild();
+		out.Write("last");
+		WHEN( "it is decoded" ) {
+			DataNode root;
+			REQUIRE( BinaryData::Decode(out.Contents(), root) );
+			THEN( "the same nodes and tokens are present" ) {
+				CHECK( Flatten(root) == "first,1,-2.5,two words,{child,-7,second child,}last,{}" );
+			}
+		}
+	}
+	GIVEN( "Data written in two sections" ) {
+		DataWriter out(DataWriter::Encoding::BINARY);
+		out.Write("pilot", "Bobbi", "Bughunter");
+		out.Write("summary");
+		out.BeginChild();
+		{
+			out.Write("credits", 131000);
+		}
+		out.EndChild();
+		out.EndSection();
+		out.Write("ship", "Star Barge");
+		out.Write("pilot", "again");
+		const std::string binary = out.Contents();
+		WHEN( "only the first section is decoded" ) {
+			const size_t length = BinaryData::FirstSectionLength(binary);
+			REQUIRE( length > 0 );
+			REQUIRE( length < binary.size() );
+			DataNode root;
+			REQUIRE( BinaryData::Decode(binary.substr(0, length), root) );
+			THEN( "only the nodes written before the split are present" ) {
+				CHECK( Flatten(root) == "pilot,Bobbi,Bughunter,{}summary,{credits,131000,}" );
+			}
+		}
+		WHEN( "all of it is decoded" ) {
+			DataNode root;
+			REQUIRE( BinaryData::Decode(binary, root) );
+			THEN( "the nodes from both sections are present" ) {
+				CHECK( Flatten(root) == "pilot,Bobbi,Bughunter,{}summary,{credits,131000,}ship,Star Barge,{}pilot,again,{}" );
+			}
+		}
+	}
+	GIVEN( "Binary data that has been cut short" ) {
+		std::string binary = Write(TEXT, DataWriter::Encoding::BINARY);
+		binary.resize(binary.size() - 3);
+		THEN( "it is rejected when decoding" ) {
+			DataNode root;
+			CHECK_FALSE( BinaryData::Decode(binary, root) );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
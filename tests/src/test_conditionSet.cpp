@@ -123,7 +123,7 @@ SCENARIO( "Determining if condition requirements are met", "[ConditionSet][Usage
 
 SCENARIO( "Applying changes to conditions", "[ConditionSet][Usage]" ) {
 	auto mutableList = ConditionSet::Conditions{};
-	REQUIRE( mutableList.empty() );
+	REQUIRE( mutableList.IsEmpty() );
 	
 	GIVEN( "an empty ConditionSet" ) {
 		const auto emptySet = ConditionSet{};
@@ -131,12 +131,12 @@ SCENARIO( "Applying changes to conditions", "[ConditionSet][Usage]" ) {
 		
 		THEN( "no conditions are added via Apply" ) {
 			emptySet.Apply(mutableList);
-			REQUIRE( mutableList.empty() );
+			REQUIRE( mutableList.IsEmpty() );
 			
-			mutableList.emplace("event: war begins", 1);
-			REQUIRE( mutableList.size() == 1 );
+			mutableList["event: war begins"] = 1;
+			REQUIRE( mutableList.Size() == 1 );
 			emptySet.Apply(mutableList);
-			REQUIRE( mutableList.size() == 1 );
+			REQUIRE( mutableList.Size() == 1 );
 		}
 	}
 	GIVEN( "a ConditionSet with only comparison expressions" ) {
@@ -149,12 +149,12 @@ SCENARIO( "Applying changes to conditions", "[ConditionSet][Usage]" ) {
 		
 		THEN( "no conditions are added via Apply" ) {
 			compareSet.Apply(mutableList);
-			REQUIRE( mutableList.empty() );
+			REQUIRE( mutableList.IsEmpty() );
 			
-			mutableList.emplace("event: war begins", 1);
-			REQUIRE( mutableList.size() == 1 );
+			mutableList["event: war begins"] = 1;
+			REQUIRE( mutableList.Size() == 1 );
 			compareSet.Apply(mutableList);
-			REQUIRE( mutableList.size() == 1 );
+			REQUIRE( mutableList.Size() == 1 );
 		}
 	}
 	GIVEN( "a ConditionSet with an assignable expression" ) {
@@ -163,11 +163,10 @@ SCENARIO( "Applying changes to conditions", "[ConditionSet][Usage]" ) {
 		
 		THEN( "the condition list is updated via Apply" ) {
 			applySet.Apply(mutableList);
-			REQUIRE_FALSE( mutableList.empty() );
+			REQUIRE_FALSE( mutableList.IsEmpty() );
 			
-			const auto &inserted = mutableList.find("year");
-			REQUIRE( inserted != mutableList.end() );
-			CHECK( inserted->second == 3013 );
+			REQUIRE( mutableList.Has("year") );
+			CHECK( mutableList.Get("year") == 3013 );
 		}
 	}
 }
@@ -0,0 +1,109 @@
+/* test_conditionsStore.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../source/ConditionsStore.h"
+
+// ... and any system includes needed for the test file.
+#include <string>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+// Get the names of the given conditions.
+std::vector<std::string> Names(const std::vector<int> &ids)
+{
+	std::vector<std::string> names;
+	for(int id : ids)
+		names.push_back(ConditionsStore::Name(id));
+	return names;
+}
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Looking up conditions by name or by ID", "[ConditionsStore]" ) {
+	GIVEN( "a condition name" ) {
+		const int id = ConditionsStore::Id("test store: first");
+		THEN( "it always has the same ID" ) {
+			CHECK( ConditionsStore::Id("test store: first") == id );
+			CHECK( ConditionsStore::Find("test store: first") == id );
+			CHECK( ConditionsStore::Name(id) == "test store: first" );
+		}
+		THEN( "a name that has never been used has no ID" ) {
+			CHECK( ConditionsStore::Find("test store: never used") == -1 );
+		}
+		AND_GIVEN( "a store in which it is set" ) {
+			ConditionsStore store;
+			store[id] = 12;
+			THEN( "its value can be found by name or by ID" ) {
+				CHECK( store.Get(id) == 12 );
+				CHECK( store.Get("test store: first") == 12 );
+				CHECK( store.Has(id) );
+				CHECK( store.Size() == 1 );
+			}
+			WHEN( "it is erased" ) {
+				store.Erase("test store: first");
+				THEN( "its value is zero and it is no longer set" ) {
+					CHECK( store.Get(id) == 0 );
+					CHECK_FALSE( store.Has(id) );
+					CHECK( store.IsEmpty() );
+				}
+			}
+		}
+	}
+	GIVEN( "a store with a condition set to zero" ) {
+		ConditionsStore store{{"test store: zero", 0}};
+		THEN( "the condition is set even though its value is zero" ) {
+			CHECK( store.Has("test store: zero") );
+			CHECK( store.Get("test store: zero") == 0 );
+		}
+	}
+}
+
+SCENARIO( "Finding conditions by prefix", "[ConditionsStore]" ) {
+	GIVEN( "a store with conditions that share a prefix" ) {
+		ConditionsStore store{
+			{"test prefix: b", 2},
+			{"test prefix: a", 1},
+			{"test prefixed", 3},
+			{"test other", 4},
+		};
+		THEN( "only those conditions are found, in alphabetical order" ) {
+			CHECK( Names(store.Ids("test prefix: ")) == std::vector<std::string>{"test prefix: a", "test prefix: b"} );
+		}
+		WHEN( "a new name with that prefix is used later" ) {
+			store["test prefix: aa"] = 5;
+			THEN( "it is found in its alphabetical place" ) {
+				CHECK( Names(store.Ids("test prefix: "))
+					== std::vector<std::string>{"test prefix: a", "test prefix: aa", "test prefix: b"} );
+			}
+		}
+		WHEN( "every condition with that prefix is erased" ) {
+			store.ErasePrefix("test prefix: ");
+			THEN( "the other conditions are still set" ) {
+				CHECK( store.Ids("test prefix: ").empty() );
+				CHECK( store.Size() == 2 );
+				CHECK( store.Get("test prefixed") == 3 );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
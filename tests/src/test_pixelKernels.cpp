@@ -0,0 +1,151 @@
+/* test_pixelKernels.cpp
+Copyright (c) 2021 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../source/PixelKernels.h"
+
+// ... and any system includes needed for the test file.
+#include <cstdint>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+// Get arbitrary but repeatable pixel values.
+std::vector<uint32_t> Random(size_t count)
+{
+	uint32_t state = 12345;
+	std::vector<uint32_t> result(count);
+	for(uint32_t &it : result)
+	{
+		state = state * 1103515245 + 12345;
+		it = state ^ (state >> 16);
+	}
+	return result;
+}
+
+// The plain, one pixel at a time conversions that the optimized versions must
+// match exactly.
+uint32_t Premultiply(uint32_t value, int additive)
+{
+	uint32_t alpha = value >> 24;
+	uint32_t result = 0;
+	for(int shift = 0; shift < 24; shift += 8)
+		result |= ((((value >> shift) & 0xFF) * alpha) / 255) << shift;
+	if(additive == 1)
+		alpha >>= 2;
+	if(additive != 2)
+		result |= alpha << 24;
+	return result;
+}
+
+std::vector<uint32_t> Shrink(const std::vector<uint32_t> &pixels, int width, int height)
+{
+	std::vector<uint32_t> result;
+	for(int y = 0; y + 1 < height; y += 2)
+		for(int x = 0; x + 1 < width; x += 2)
+		{
+			const uint32_t *a = &pixels[y * width + x];
+			const uint32_t *b = a + width;
+			uint32_t value = 0;
+			for(int shift = 0; shift < 32; shift += 8)
+			{
+				uint32_t sum = ((a[0] >> shift) & 0xFF) + ((a[1] >> shift) & 0xFF)
+					+ ((b[0] >> shift) & 0xFF) + ((b[1] >> shift) & 0xFF);
+				value |= ((sum + 2) / 4) << shift;
+			}
+			result.push_back(value);
+		}
+	return result;
+}
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Converting pixels to premultiplied alpha", "[PixelKernels]" ) {
+	GIVEN( "Pixels with every combination of color and alpha" ) {
+		std::vector<uint32_t> before;
+		for(uint32_t alpha = 0; alpha < 256; ++alpha)
+			for(uint32_t color = 0; color < 256; ++color)
+				before.push_back((alpha << 24) | (color << 16) | ((255 - color) << 8) | (color ^ 0x5A));
+		std::vector<uint32_t> after = before;
+		
+		// Check that every pixel matches the plain conversion.
+		auto matches = [&before, &after](int additive) -> bool
+		{
+			for(size_t i = 0; i < before.size(); ++i)
+				if(after[i] != Premultiply(before[i], additive))
+					return false;
+			return true;
+		};
+		WHEN( "they are converted to premultiplied alpha" ) {
+			PixelKernels::Premultiply(after.data(), after.data() + after.size(), 0);
+			THEN( "every pixel matches the plain conversion" ) {
+				CHECK( matches(0) );
+			}
+		}
+		WHEN( "they are converted to half-additive mixing" ) {
+			PixelKernels::Premultiply(after.data(), after.data() + after.size(), 1);
+			THEN( "every pixel matches the plain conversion" ) {
+				CHECK( matches(1) );
+			}
+		}
+		WHEN( "they are converted to additive mixing" ) {
+			PixelKernels::Premultiply(after.data(), after.data() + after.size(), 2);
+			THEN( "every pixel matches the plain conversion" ) {
+				CHECK( matches(2) );
+			}
+		}
+	}
+	GIVEN( "A number of pixels that is not a multiple of the vector size" ) {
+		const std::vector<uint32_t> before = Random(13 * 3);
+		std::vector<uint32_t> after = before;
+		WHEN( "only part of them is converted" ) {
+			PixelKernels::Premultiply(after.data() + 1, after.data() + after.size() - 1, 0);
+			THEN( "every pixel in that range matches the plain conversion" ) {
+				for(size_t i = 1; i + 1 < before.size(); ++i)
+					CHECK( after[i] == Premultiply(before[i], 0) );
+			}
+			THEN( "the pixels outside that range are unchanged" ) {
+				CHECK( after.front() == before.front() );
+				CHECK( after.back() == before.back() );
+			}
+		}
+	}
+}
+
+SCENARIO( "Shrinking rows of pixels to half size", "[PixelKernels]" ) {
+	GIVEN( "Rows with an odd width" ) {
+		const int width = 45;
+		const int height = 8;
+		const std::vector<uint32_t> before = Random(width * height);
+		WHEN( "each pair of rows is shrunk" ) {
+			std::vector<uint32_t> after((width / 2) * (height / 2));
+			for(int y = 0; y < height / 2; ++y)
+			{
+				const uint32_t *a = before.data() + width * (2 * y);
+				PixelKernels::ShrinkRow(a, a + width, after.data() + (width / 2) * y, width / 2);
+			}
+			THEN( "each pixel is the rounded average of a 2x2 block" ) {
+				CHECK( after == Shrink(before, width, height) );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
@@ -15,8 +15,12 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 // Include only the tested class's header.
 #include "../../source/Set.h"
 
+// Include a helper for creating well-formed DataNodes.
+#include "datanode-factory.h"
+
 // ... and any system includes needed for the test file.
 #include <string>
+#include <vector>
 
 namespace { // test namespace
 // #region mock data
@@ -24,6 +28,21 @@ class T {
 public:
 	int a = 1;
 };
+
+class Loadable {
+public:
+	void Load(const DataNode &node) { tokens.push_back(node.Token(1)); }
+	std::vector<std::string> tokens;
+};
+
+// An object whose definition refers to an object in another Set, the way that
+// a mission refers to the outfits it gives the player.
+Set<T> referenced;
+class Referrer {
+public:
+	void Load(const DataNode &node) { target = referenced.Get(node.Token(1)); }
+	const T *target = nullptr;
+};
 // #endregion mock data
 
 
@@ -86,6 +105,20 @@ SCENARIO( "a Set can be interacted with by consuming classes even when const", "
 			}
 		}
 	}
+	
+	GIVEN( "data for the key exists and the key is given as a C string" ) {
+		const auto s = Set<T>{};
+		const auto &firstPtr = s.Get(key);
+		
+		WHEN( "Get or Find is called" ) {
+			THEN( "the same object is returned as for a std::string key" ) {
+				CHECK( s.Get("a value") == firstPtr );
+				CHECK( s.Find("a value") == firstPtr );
+				CHECK( s.Find("another value") == nullptr );
+				CHECK( s.size() == 1 );
+			}
+		}
+	}
 }
 
 
@@ -140,6 +173,64 @@ SCENARIO( "A Set can be reverted to an earlier state", "[Set]" ) {
 		}
 	}
 }
+
+SCENARIO( "A Set can defer loading objects until they are requested", "[Set]" ) {
+	GIVEN( "a Set with two definitions of the same deferred object" ) {
+		auto s = Set<Loadable>{};
+		s.Defer("A", AsDataNode("thing first"));
+		s.Defer("A", AsDataNode("thing second"));
+		REQUIRE( s.IsDeferred("A") );
+		
+		THEN( "the object is counted but not yet loaded" ) {
+			CHECK( s.Has("A") );
+			CHECK( s.size() == 1 );
+			CHECK( s.Loaded().empty() );
+		}
+		WHEN( "Find(key) is called" ) {
+			const auto *object = s.Find("A");
+			THEN( "all definitions are loaded in order" ) {
+				REQUIRE( object != nullptr );
+				CHECK( object->tokens == std::vector<std::string>{"first", "second"} );
+				CHECK_FALSE( s.IsDeferred("A") );
+				CHECK( s.size() == 1 );
+			}
+		}
+		WHEN( "the object is requested before another definition is given" ) {
+			const auto *object = s.Get("A");
+			s.Defer("A", AsDataNode("thing third"));
+			THEN( "the new definition is loaded immediately into the same object" ) {
+				CHECK( object == s.Find("A") );
+				CHECK( object->tokens == std::vector<std::string>{"first", "second", "third"} );
+			}
+		}
+		WHEN( "the Set is iterated over" ) {
+			s.Defer("B", AsDataNode("thing other"));
+			int count = 0;
+			for(const auto &it : s)
+				count += !it.second.tokens.empty();
+			THEN( "every deferred object is loaded" ) {
+				CHECK( count == 2 );
+				CHECK( s.Deferred().empty() );
+			}
+		}
+	}
+	
+	GIVEN( "a deferred object that refers to an object in another Set" ) {
+		referenced = Set<T>{};
+		auto s = Set<Referrer>{};
+		s.Defer("A", AsDataNode("referrer misspelled"));
+		REQUIRE_FALSE( referenced.Has("misspelled") );
+		
+		WHEN( "every deferred object is loaded" ) {
+			s.LoadAll();
+			THEN( "the referenced object exists, so it can be reported if it is never defined" ) {
+				CHECK( referenced.Has("misspelled") );
+				CHECK( s.Find("A")->target == referenced.Find("misspelled") );
+				CHECK( s.Deferred().empty() );
+			}
+		}
+	}
+}
 // #endregion unit tests
 
 
@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "../../../source/text/Format.h"
 
 // ... and any system includes needed for the test file.
+#include <map>
 #include <string>
 
 namespace { // test namespace
@@ -139,6 +140,33 @@ TEST_CASE( "Format::Number", "[Format][Number]") {
 	}
 }
 
+TEST_CASE( "Format::Replace", "[Format][Replace]") {
+	const std::map<std::string, std::string> keys = {
+		{"<planet>", "Earth"},
+		{"<system>", "Sol"},
+		{"<first>", "<last>"},
+	};
+	SECTION( "Strings without keys" ) {
+		CHECK( Format::Replace("", keys) == "" );
+		CHECK( Format::Replace("no keys here", keys) == "no keys here" );
+		CHECK( Format::Replace("no keys here", {}) == "no keys here" );
+	}
+	SECTION( "Known keys are replaced" ) {
+		CHECK( Format::Replace("<planet>", keys) == "Earth" );
+		CHECK( Format::Replace("Fly to <planet> in <system>.", keys) == "Fly to Earth in Sol." );
+		CHECK( Format::Replace("<planet><planet>", keys) == "EarthEarth" );
+	}
+	SECTION( "Unknown or unfinished keys are left alone" ) {
+		CHECK( Format::Replace("<unknown> <planet>", keys) == "<unknown> Earth" );
+		CHECK( Format::Replace("a < b <planet>", keys) == "a < b Earth" );
+		CHECK( Format::Replace("<<planet>>", keys) == "<Earth>" );
+		CHECK( Format::Replace("<planet", keys) == "<planet" );
+	}
+	SECTION( "Replacements are not themselves replaced" ) {
+		CHECK( Format::Replace("<first>", keys) == "<last>" );
+	}
+}
+
 // #endregion unit tests
 
 // #region benchmarks